@@ -0,0 +1,234 @@
+#ifndef __NUOSCILLATOR_BENCHMARKPERFCOUNTERS_H__
+#define __NUOSCILLATOR_BENCHMARKPERFCOUNTERS_H__
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <cstring>
+#include <cstdlib>
+#include <dirent.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file BenchmarkPerfCounters.h
+ *
+ * @brief Hardware performance counters read through Linux perf_event_open, used by the benchmark executables
+ */
+
+/**
+ * @brief Definition of one hardware counter, either a generic PERF_TYPE_HARDWARE event or a CPU specific raw event
+ */
+struct PerfCounterDefinition {
+  std::string Name;
+  unsigned int Type;
+  unsigned long long Config;
+};
+
+/**
+ * @brief Generic counters: cycles, instructions, last level cache misses and branch misses
+ */
+inline std::vector<PerfCounterDefinition> ReturnDefaultPerfCounters() {
+  std::vector<PerfCounterDefinition> Definitions;
+#ifdef __linux__
+  Definitions.push_back({"Cycles",PERF_TYPE_HARDWARE,PERF_COUNT_HW_CPU_CYCLES});
+  Definitions.push_back({"Instructions",PERF_TYPE_HARDWARE,PERF_COUNT_HW_INSTRUCTIONS});
+  Definitions.push_back({"LLCMisses",PERF_TYPE_HARDWARE,PERF_COUNT_HW_CACHE_MISSES});
+  Definitions.push_back({"BranchMisses",PERF_TYPE_HARDWARE,PERF_COUNT_HW_BRANCH_MISSES});
+#endif
+  return Definitions;
+}
+
+/**
+ * @brief CPU specific raw counter, e.g. 0xfcc7 for packed FP_ARITH_INST_RETIRED on recent Intel cores
+ *
+ * @param Name Name used to report the counter
+ * @param Config Raw event code as a decimal or 0x prefixed hexadecimal string
+ */
+inline PerfCounterDefinition ReturnRawPerfCounter(std::string Name, std::string Config) {
+#ifdef __linux__
+  unsigned int Type = PERF_TYPE_RAW;
+#else
+  unsigned int Type = 0;
+#endif
+  return {Name,Type,std::stoull(Config,nullptr,0)};
+}
+
+/**
+ * @brief A set of hardware counters covering every thread of this process which exists when the set is created
+ *
+ * OpenMP worker threads are only counted if they were started before construction, so the counters should be created after some warm-up reweights. Counters which
+ * cannot be opened (e.g. in containers, with a restrictive perf_event_paranoid, or on CPUs without the requested raw event) are reported as unavailable rather than
+ * causing an error. A counter which could only be opened on some of the threads is also reported as unavailable, as its sum would miss the work of the others.
+ * Values are scaled for any time the kernel multiplexed the counter off the PMU.
+ */
+class PerfCounterSet {
+ public:
+  PerfCounterSet(const std::vector<PerfCounterDefinition>& Definitions_) : Definitions(Definitions_), FileDescriptors(Definitions_.size()), nThreads(1) {
+#ifdef __linux__
+    std::vector<int> ThreadIDs = ReturnThreadIDs();
+    nThreads = (int)ThreadIDs.size();
+
+    for (size_t iCounter=0;iCounter<Definitions.size();iCounter++) {
+      for (size_t iThread=0;iThread<ThreadIDs.size();iThread++) {
+	struct perf_event_attr Attributes;
+	memset(&Attributes,0,sizeof(Attributes));
+	Attributes.size = sizeof(Attributes);
+	Attributes.type = Definitions[iCounter].Type;
+	Attributes.config = Definitions[iCounter].Config;
+	Attributes.disabled = 1;
+	Attributes.exclude_kernel = 1;
+	Attributes.exclude_hv = 1;
+	Attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	int FileDescriptor = syscall(__NR_perf_event_open,&Attributes,ThreadIDs[iThread],-1,-1,0);
+	if (FileDescriptor >= 0) {
+	  FileDescriptors[iCounter].push_back(FileDescriptor);
+	}
+      }
+
+      // Only warn the first time, the same counters are opened again for every benchmarked configuration
+      static std::set<std::string> Warned;
+      if (FileDescriptors[iCounter].size() == 0 && Warned.insert(Definitions[iCounter].Name).second) {
+	std::cerr << "WARNING - Hardware counter " << Definitions[iCounter].Name << " is not available (container, perf_event_paranoid or CPU without the event) and will be reported as -1" << std::endl;
+      } else if (!IsComplete(iCounter) && Warned.insert(Definitions[iCounter].Name).second) {
+	std::cerr << "WARNING - Hardware counter " << Definitions[iCounter].Name << " could only be opened on " << FileDescriptors[iCounter].size() << " of " << nThreads
+		  << " threads and will be reported as -1" << std::endl;
+      }
+    }
+#else
+    std::cerr << "WARNING - Hardware counters are only supported on Linux and will be reported as -1" << std::endl;
+#endif
+  }
+
+  ~PerfCounterSet() {
+#ifdef __linux__
+    for (size_t iCounter=0;iCounter<FileDescriptors.size();iCounter++) {
+      for (size_t iFD=0;iFD<FileDescriptors[iCounter].size();iFD++) {
+	close(FileDescriptors[iCounter][iFD]);
+      }
+    }
+#endif
+  }
+
+  PerfCounterSet(const PerfCounterSet&) = delete;
+  PerfCounterSet& operator=(const PerfCounterSet&) = delete;
+
+  /**
+   * @brief Whether any counter could be opened on every thread
+   */
+  bool IsAvailable() {
+    for (size_t iCounter=0;iCounter<FileDescriptors.size();iCounter++) {
+      if (IsComplete(iCounter)) return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Number of threads of this process when the set was created, which every available counter covers
+   */
+  int ReturnNThreads() {return nThreads;}
+
+  /**
+   * @brief Reset all counters to zero and start counting
+   */
+  void Start() {
+    ApplyToAll(PERF_EVENT_IOC_RESET_VALUE);
+    ApplyToAll(PERF_EVENT_IOC_ENABLE_VALUE);
+  }
+
+  /**
+   * @brief Stop counting
+   */
+  void Stop() {
+    ApplyToAll(PERF_EVENT_IOC_DISABLE_VALUE);
+  }
+
+  /**
+   * @brief Value of each counter summed over threads since the last Start(), or -1 if it is unavailable or could not be read on every thread
+   */
+  std::vector<double> Read() {
+    std::vector<double> Values(Definitions.size(),-1.);
+#ifdef __linux__
+    for (size_t iCounter=0;iCounter<Definitions.size();iCounter++) {
+      if (!IsComplete(iCounter)) continue;
+
+      double Sum = 0.;
+      bool AllRead = true;
+      for (size_t iFD=0;iFD<FileDescriptors[iCounter].size();iFD++) {
+	// value, time enabled, time running
+	unsigned long long Buffer[3] = {0,0,0};
+	if (read(FileDescriptors[iCounter][iFD],Buffer,sizeof(Buffer)) != sizeof(Buffer)) {
+	  AllRead = false;
+	  break;
+	}
+	if (Buffer[2] > 0) {
+	  Sum += (double)Buffer[0]*((double)Buffer[1]/(double)Buffer[2]);
+	}
+      }
+      if (AllRead) Values[iCounter] = Sum;
+    }
+#endif
+    return Values;
+  }
+
+  std::vector<PerfCounterDefinition> ReturnDefinitions() {return Definitions;}
+
+ private:
+#ifdef __linux__
+  static constexpr unsigned long PERF_EVENT_IOC_RESET_VALUE = PERF_EVENT_IOC_RESET;
+  static constexpr unsigned long PERF_EVENT_IOC_ENABLE_VALUE = PERF_EVENT_IOC_ENABLE;
+  static constexpr unsigned long PERF_EVENT_IOC_DISABLE_VALUE = PERF_EVENT_IOC_DISABLE;
+#else
+  static constexpr unsigned long PERF_EVENT_IOC_RESET_VALUE = 0;
+  static constexpr unsigned long PERF_EVENT_IOC_ENABLE_VALUE = 0;
+  static constexpr unsigned long PERF_EVENT_IOC_DISABLE_VALUE = 0;
+#endif
+
+  void ApplyToAll(unsigned long Request) {
+#ifdef __linux__
+    for (size_t iCounter=0;iCounter<FileDescriptors.size();iCounter++) {
+      for (size_t iFD=0;iFD<FileDescriptors[iCounter].size();iFD++) {
+	ioctl(FileDescriptors[iCounter][iFD],Request,0);
+      }
+    }
+#else
+    (void)Request;
+#endif
+  }
+
+  // Whether the counter was opened on every thread
+  bool IsComplete(size_t iCounter) {
+    return FileDescriptors[iCounter].size() > 0 && (int)FileDescriptors[iCounter].size() == nThreads;
+  }
+
+  // Thread IDs of every thread of this process, read from /proc/self/task
+  static std::vector<int> ReturnThreadIDs() {
+    std::vector<int> ThreadIDs;
+    DIR* Directory = opendir("/proc/self/task");
+    if (Directory != NULL) {
+      struct dirent* Entry;
+      while ((Entry = readdir(Directory)) != NULL) {
+	int ThreadID = atoi(Entry->d_name);
+	if (ThreadID > 0) ThreadIDs.push_back(ThreadID);
+      }
+      closedir(Directory);
+    }
+    if (ThreadIDs.size() == 0) {
+      ThreadIDs.push_back(0);
+    }
+    return ThreadIDs;
+  }
+
+  std::vector<PerfCounterDefinition> Definitions;
+  std::vector< std::vector<int> > FileDescriptors;
+  int nThreads;
+};
+
+#endif
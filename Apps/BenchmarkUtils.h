@@ -0,0 +1,340 @@
+#ifndef __NUOSCILLATOR_BENCHMARKUTILS_H__
+#define __NUOSCILLATOR_BENCHMARKUTILS_H__
+
+#include "Oscillator/OscillatorFactory.h"
+
+#include "Constants/OscillatorConstants.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <random>
+#include <math.h>
+
+#if UseMultithreading == 1
+#include "omp.h"
+#endif
+
+/**
+ * @file BenchmarkUtils.h
+ *
+ * @brief Helpers shared by the benchmark executables: building Oscillators on a requested grid and thread count, throwing oscillation parameters,
+ * summarising timing distributions and writing machine-readable results
+ */
+
+/**
+ * @brief Summary statistics of a set of timings, all in milliseconds
+ */
+struct TimingSummary {
+  int nSamples;
+  double Mean;
+  double StdDev;
+  double Median;
+  double P5;
+  double P95;
+  double Min;
+  double Max;
+};
+
+/**
+ * @brief Percentile of a sorted array, linearly interpolating between neighbouring entries
+ */
+inline double ReturnPercentile(const std::vector<double>& SortedValues, double Percentile) {
+  if (SortedValues.size() == 0) return 0.;
+  double Position = Percentile/100.*(SortedValues.size()-1);
+  size_t Lower = (size_t)floor(Position);
+  size_t Upper = std::min(Lower+1,SortedValues.size()-1);
+  double Fraction = Position-Lower;
+  return SortedValues[Lower]+Fraction*(SortedValues[Upper]-SortedValues[Lower]);
+}
+
+inline TimingSummary SummariseTimes(std::vector<double> Times) {
+  TimingSummary Summary;
+  Summary.nSamples = Times.size();
+
+  std::sort(Times.begin(),Times.end());
+  double Sum = 0.;
+  for (size_t i=0;i<Times.size();i++) {
+    Sum += Times[i];
+  }
+  Summary.Mean = Times.size() > 0 ? Sum/Times.size() : 0.;
+
+  double SumSquares = 0.;
+  for (size_t i=0;i<Times.size();i++) {
+    SumSquares += (Times[i]-Summary.Mean)*(Times[i]-Summary.Mean);
+  }
+  Summary.StdDev = Times.size() > 1 ? sqrt(SumSquares/(Times.size()-1)) : 0.;
+
+  Summary.Median = ReturnPercentile(Times,50.);
+  Summary.P5 = ReturnPercentile(Times,5.);
+  Summary.P95 = ReturnPercentile(Times,95.);
+  Summary.Min = Times.size() > 0 ? Times.front() : 0.;
+  Summary.Max = Times.size() > 0 ? Times.back() : 0.;
+  return Summary;
+}
+
+/**
+ * @brief One row of benchmark output, an ordered list of named values which are written as a JSON object or a CSV row
+ */
+struct BenchmarkRecord {
+  std::vector<std::string> Keys;
+  std::vector<std::string> Values;
+  std::vector<bool> IsString;
+
+  void Add(const std::string& Key, const std::string& Value) {
+    Keys.push_back(Key);
+    Values.push_back(Value);
+    IsString.push_back(true);
+  }
+
+  void Add(const std::string& Key, const char* Value) {
+    Add(Key,std::string(Value));
+  }
+
+  void Add(const std::string& Key, double Value) {
+    std::ostringstream Stream;
+    Stream << std::setprecision(8) << Value;
+    Keys.push_back(Key);
+    Values.push_back(Stream.str());
+    IsString.push_back(false);
+  }
+
+  void Add(const std::string& Key, long Value) {
+    Keys.push_back(Key);
+    Values.push_back(std::to_string(Value));
+    IsString.push_back(false);
+  }
+
+  void Add(const std::string& Key, int Value) {
+    Add(Key,(long)Value);
+  }
+
+  void Add(const std::string& Key, const TimingSummary& Summary, const std::string& Unit="ms") {
+    Add(Key+"Mean_"+Unit,Summary.Mean);
+    Add(Key+"StdDev_"+Unit,Summary.StdDev);
+    Add(Key+"Median_"+Unit,Summary.Median);
+    Add(Key+"P5_"+Unit,Summary.P5);
+    Add(Key+"P95_"+Unit,Summary.P95);
+    Add(Key+"Min_"+Unit,Summary.Min);
+    Add(Key+"Max_"+Unit,Summary.Max);
+  }
+};
+
+inline std::string JSONEscape(const std::string& Input) {
+  std::string Output;
+  for (char Character : Input) {
+    if (Character == '"' || Character == '\\') Output += '\\';
+    Output += Character;
+  }
+  return Output;
+}
+
+inline bool HasSuffix(const std::string& Input, const std::string& Suffix) {
+  return Input.size() >= Suffix.size() && Input.compare(Input.size()-Suffix.size(),Suffix.size(),Suffix) == 0;
+}
+
+/**
+ * @brief Write benchmark records to FileName. Files ending in ".csv" are written as CSV (columns taken from the first record), anything else as JSON
+ *
+ * The JSON layout is {"Mode": ..., "Build": {...}, "Results": [{...}, ...]}, which is also valid YAML such that it can be read back with YAML::LoadFile
+ */
+inline void WriteBenchmarkRecords(const std::string& FileName, const std::string& Mode, const std::vector<BenchmarkRecord>& Records) {
+  std::ofstream File(FileName);
+  if (!File.is_open()) {
+    std::cerr << "Could not open benchmark output file:" << FileName << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+
+  if (HasSuffix(FileName,".csv")) {
+    if (Records.size() > 0) {
+      for (size_t iKey=0;iKey<Records[0].Keys.size();iKey++) {
+	File << (iKey == 0 ? "" : ",") << Records[0].Keys[iKey];
+      }
+      File << "\n";
+    }
+    for (const BenchmarkRecord& Record : Records) {
+      for (size_t iKey=0;iKey<Record.Keys.size();iKey++) {
+	File << (iKey == 0 ? "" : ",");
+	if (Record.IsString[iKey]) {
+	  File << "\"" << Record.Values[iKey] << "\"";
+	} else {
+	  File << Record.Values[iKey];
+	}
+      }
+      File << "\n";
+    }
+  } else {
+    File << "{\n";
+    File << "  \"Mode\": \"" << JSONEscape(Mode) << "\",\n";
+    File << "  \"Build\": {\"UseMultithreading\": " << UseMultithreading << ", \"UseDoubles\": " << UseDoubles << "},\n";
+    File << "  \"Results\": [\n";
+    for (size_t iRecord=0;iRecord<Records.size();iRecord++) {
+      File << "    {";
+      for (size_t iKey=0;iKey<Records[iRecord].Keys.size();iKey++) {
+	File << (iKey == 0 ? "" : ", ") << "\"" << JSONEscape(Records[iRecord].Keys[iKey]) << "\": ";
+	if (Records[iRecord].IsString[iKey]) {
+	  File << "\"" << JSONEscape(Records[iRecord].Values[iKey]) << "\"";
+	} else {
+	  File << Records[iRecord].Values[iKey];
+	}
+      }
+      File << "}" << (iRecord+1 < Records.size() ? "," : "") << "\n";
+    }
+    File << "  ]\n";
+    File << "}\n";
+  }
+
+  std::cout << "Written " << Records.size() << " benchmark results to " << FileName << std::endl;
+}
+
+/**
+ * @brief Set the number of OpenMP threads used by Oscillators created after this call, where nThreads <= 0 restores the default. Returns the number of threads which will actually be used
+ */
+inline int SetBenchmarkThreads(int nThreads) {
+#if UseMultithreading == 1
+  static const int DefaultThreads = omp_get_max_threads();
+  omp_set_num_threads(nThreads > 0 ? nThreads : DefaultThreads);
+  return omp_get_max_threads();
+#else
+  if (nThreads > 1) {
+    std::cerr << "WARNING - Requested " << nThreads << " threads but NuOscillator was built with UseMultithreading=0. Running on one thread" << std::endl;
+  }
+  return 1;
+#endif
+}
+
+/**
+ * @brief Read a "Name: value kB" field from /proc/self/status. Returns -1 if it is unavailable (e.g. not running on Linux)
+ */
+inline long ReturnProcStatusKB(const std::string& FieldName) {
+  std::ifstream Status("/proc/self/status");
+  std::string Line;
+  while (std::getline(Status,Line)) {
+    if (Line.compare(0,FieldName.size()+1,FieldName+":") == 0) {
+      return atol(Line.c_str()+FieldName.size()+1);
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Current resident set size of this process in kB
+ */
+inline long ReturnCurrentRSSKB() {
+  return ReturnProcStatusKB("VmRSS");
+}
+
+/**
+ * @brief Peak resident set size of this process in kB since it started, or since the last successful ResetPeakRSS()
+ */
+inline long ReturnPeakRSSKB() {
+  return ReturnProcStatusKB("VmHWM");
+}
+
+/**
+ * @brief Reset the peak resident set size to the current one, such that ReturnPeakRSSKB() covers only what follows. Returns false if the kernel does not allow it
+ */
+inline bool ResetPeakRSS() {
+  std::ofstream ClearRefs("/proc/self/clear_refs");
+  if (!ClearRefs.is_open()) return false;
+  ClearRefs << "5";
+  ClearRefs.close();
+  return !ClearRefs.fail();
+}
+
+/**
+ * @brief Number of processors available to OpenMP, or 1 if NuOscillator was built without multithreading
+ */
+inline int ReturnAvailableThreads() {
+#if UseMultithreading == 1
+  return omp_get_num_procs();
+#else
+  return 1;
+#endif
+}
+
+/**
+ * @brief Create and setup an Oscillator from Config
+ *
+ * If the Oscillator does not set its evaluation points in the constructor, nEnergyPoints log-spaced energies in [0.1,100] GeV and nCosineZPoints cosine zenith
+ * values in [-1,1] are used. The oscillation parameters of the config are overwritten by any matching entry of GlobalParameters, and OscillationParameters is
+ * filled with the values which the Oscillator points to.
+ */
+inline OscillatorBase* CreateBenchmarkOscillator(YAML::Node Config, int nEnergyPoints, int nCosineZPoints,
+						 const std::unordered_map<std::string, FLOAT_T>& GlobalParameters,
+						 std::unordered_map<std::string, FLOAT_T>& OscillationParameters) {
+  OscillatorFactory* OscFactory = new OscillatorFactory();
+  OscillatorBase* Oscillator = OscFactory->CreateOscillator(Config);
+  delete OscFactory;
+
+  if (!Oscillator->EvalPointsSetInConstructor()) {
+    Oscillator->SetEnergyArrayInCalcer(logspace(0.1,100.,nEnergyPoints));
+    if (!Oscillator->ReturnCosineZIgnored()) {
+      Oscillator->SetCosineZArrayInCalcer(linspace(-1.0,1.0,nCosineZPoints));
+    }
+  }
+
+  OscillationParameters = ReturnOscParamsFromConfig(Config);
+  for (auto Parameter : GlobalParameters) {
+    if (OscillationParameters.count(Parameter.first)) {
+      OscillationParameters[Parameter.first] = Parameter.second;
+    }
+  }
+  for (auto Parameter : OscillationParameters) {
+    Oscillator->DefineParameter(Parameter.first, &OscillationParameters[Parameter.first]);
+  }
+
+  Oscillator->Setup();
+  return Oscillator;
+}
+
+inline OscillatorBase* CreateBenchmarkOscillator(const std::string& ConfigName, int nEnergyPoints, int nCosineZPoints,
+						 const std::unordered_map<std::string, FLOAT_T>& GlobalParameters,
+						 std::unordered_map<std::string, FLOAT_T>& OscillationParameters) {
+  return CreateBenchmarkOscillator(YAML::LoadFile(ConfigName),nEnergyPoints,nCosineZPoints,GlobalParameters,OscillationParameters);
+}
+
+/**
+ * @brief Throws new values for the varied oscillation parameters
+ *
+ * delta_cp is thrown uniformly in [-pi,pi] and every other parameter uniformly within 5% of its nominal value. VariedParameter is either the name of a single
+ * parameter or "All"
+ */
+class OscillationParameterThrower {
+ public:
+  OscillationParameterThrower(const std::unordered_map<std::string, FLOAT_T>& NominalParameters_, const std::string& VariedParameter_, unsigned int Seed) :
+    NominalParameters(NominalParameters_), VariedParameter(VariedParameter_), Generator(Seed), Uniform(0.,1.) {
+    // Fixed ordering such that the same seed gives the same throws regardless of the hash map layout
+    for (auto Parameter : NominalParameters) {
+      ParameterNames.push_back(Parameter.first);
+    }
+    std::sort(ParameterNames.begin(),ParameterNames.end());
+  }
+
+  bool IsValid() {
+    return VariedParameter == "All" || NominalParameters.count(VariedParameter);
+  }
+
+  void Throw(std::unordered_map<std::string, FLOAT_T>& OscillationParameters) {
+    for (const std::string& ParameterName : ParameterNames) {
+      if (VariedParameter != "All" && ParameterName != VariedParameter) continue;
+
+      if (ParameterName == "delta_cp") {
+	OscillationParameters[ParameterName] = -M_PI+2.*M_PI*Uniform(Generator);
+      } else {
+	OscillationParameters[ParameterName] = NominalParameters[ParameterName]*(0.95+0.1*Uniform(Generator));
+      }
+    }
+  }
+
+ private:
+  std::unordered_map<std::string, FLOAT_T> NominalParameters;
+  std::vector<std::string> ParameterNames;
+  std::string VariedParameter;
+  std::mt19937 Generator;
+  std::uniform_real_distribution<double> Uniform;
+};
+
+#endif
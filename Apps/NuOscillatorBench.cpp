@@ -0,0 +1,1217 @@
+#include "BenchmarkUtils.h"
+#include "BenchmarkPerfCounters.h"
+
+#include <iostream>
+#include <math.h>
+#include <chrono>
+#include <cstdint>
+#include <unordered_set>
+
+using std::chrono::high_resolution_clock;
+using std::chrono::duration;
+
+void PrintUsage(char* ExecName) {
+  std::cerr << "Usage:" << std::endl;
+  std::cerr << ExecName << " run BenchmarkConfig.yaml [Output.json|Output.csv]" << std::endl;
+  std::cerr << "    Sweep engine x grid size x thread count x varied parameter and write the reweight timing distribution of each combination" << std::endl;
+  std::cerr << ExecName << " scaling BenchmarkConfig.yaml [Output.json|Output.csv]" << std::endl;
+  std::cerr << "    Run each engine at 1, 2, 4 ... N threads on a fixed grid (strong scaling) and on a grid which grows with the thread count (weak scaling)" << std::endl;
+  std::cerr << ExecName << " setup BenchmarkConfig.yaml [Output.json|Output.csv]" << std::endl;
+  std::cerr << "    Time each phase from factory construction to the first reweight and record the memory held by each engine and grid size" << std::endl;
+  std::cerr << ExecName << " pareto BenchmarkConfig.yaml [Output.json|Output.csv]" << std::endl;
+  std::cerr << "    Sweep engine accuracy settings, measure the probability deviation from a high precision reference and the reweight time, and report the Pareto front" << std::endl;
+  std::cerr << ExecName << " lookup BenchmarkConfig.yaml [Output.json|Output.csv]" << std::endl;
+  std::cerr << "    Time ReturnWeightPointer over synthetic uniform, clustered and out-of-range event sets for each Oscillator and report lookups per second" << std::endl;
+  std::cerr << ExecName << " compare Baseline.json Current.json [Tolerance=0.1]" << std::endl;
+  std::cerr << "    Flag every result whose median reweight time is more than (1+Tolerance) times the baseline. Returns 1 if any slowdown is found, or if any baseline result is missing from the current run" << std::endl;
+}
+
+// Time nIterations reweights of Oscillator after nWarmup untimed reweights, throwing new parameter values before each one
+std::vector<double> TimeReweights(OscillatorBase* Oscillator, OscillationParameterThrower& Thrower, std::unordered_map<std::string, FLOAT_T>& OscillationParameters,
+				  int nWarmup, int nIterations) {
+  for (int iWarmup=0;iWarmup<nWarmup;iWarmup++) {
+    Thrower.Throw(OscillationParameters);
+    Oscillator->CalculateProbabilities();
+  }
+
+  std::vector<double> Times(nIterations);
+  for (int iIteration=0;iIteration<nIterations;iIteration++) {
+    Thrower.Throw(OscillationParameters);
+
+    auto t1 = high_resolution_clock::now();
+    Oscillator->CalculateProbabilities();
+    auto t2 = high_resolution_clock::now();
+    duration<double, std::milli> ms_double = t2-t1;
+    Times[iIteration] = ms_double.count();
+  }
+
+  return Times;
+}
+
+// Hardware counters of each stage of CalculateProbabilities(), averaged over reweights, along with the number of threads they cover. Unavailable counters are -1
+struct StageCounters {
+  std::vector<double> Calcer;
+  std::vector<double> Post;
+  int nThreads;
+};
+
+// Count nIterations reweights of Oscillator, reading the counters separately around the OscProbCalcer reweight and the PostCalculateProbabilities() stage
+StageCounters CountReweights(OscillatorBase* Oscillator, OscillationParameterThrower& Thrower, std::unordered_map<std::string, FLOAT_T>& OscillationParameters,
+			     int nIterations, const std::vector<PerfCounterDefinition>& Definitions) {
+  // Opened after the timed reweights so that every OpenMP worker thread already exists
+  PerfCounterSet CalcerCounters(Definitions);
+  PerfCounterSet PostCounters(Definitions);
+
+  StageCounters Counters;
+  Counters.Calcer.assign(Definitions.size(),0.);
+  Counters.Post.assign(Definitions.size(),0.);
+  Counters.nThreads = CalcerCounters.ReturnNThreads();
+
+  for (int iIteration=0;iIteration<nIterations;iIteration++) {
+    Thrower.Throw(OscillationParameters);
+
+    CalcerCounters.Start();
+    Oscillator->RunCalcerReweight();
+    CalcerCounters.Stop();
+
+    PostCounters.Start();
+    Oscillator->RunPostCalculateProbabilities();
+    PostCounters.Stop();
+
+    std::vector<double> CalcerValues = CalcerCounters.Read();
+    std::vector<double> PostValues = PostCounters.Read();
+    for (size_t iCounter=0;iCounter<Definitions.size();iCounter++) {
+      Counters.Calcer[iCounter] = (CalcerValues[iCounter] < 0 || Counters.Calcer[iCounter] < 0) ? -1. : Counters.Calcer[iCounter]+CalcerValues[iCounter]/nIterations;
+      Counters.Post[iCounter] = (PostValues[iCounter] < 0 || Counters.Post[iCounter] < 0) ? -1. : Counters.Post[iCounter]+PostValues[iCounter]/nIterations;
+    }
+  }
+
+  return Counters;
+}
+
+// Add the per reweight counters of one stage to Record as Stage_Name, along with the instructions per cycle when both are available
+void AddStageCounters(BenchmarkRecord& Record, const std::string& Stage, const std::vector<double>& Values, const std::vector<PerfCounterDefinition>& Definitions) {
+  double Cycles = -1.;
+  double Instructions = -1.;
+  for (size_t iCounter=0;iCounter<Definitions.size();iCounter++) {
+    Record.Add(Stage+"_"+Definitions[iCounter].Name,Values[iCounter]);
+    if (Definitions[iCounter].Name == "Cycles") Cycles = Values[iCounter];
+    if (Definitions[iCounter].Name == "Instructions") Instructions = Values[iCounter];
+  }
+  Record.Add(Stage+"_IPC",(Cycles > 0 && Instructions >= 0) ? Instructions/Cycles : -1.);
+}
+
+int RunBenchmark(const std::string& BenchmarkConfigName, std::string OutputName) {
+  // Start from the default number of threads, whatever an earlier mode left behind
+  SetBenchmarkThreads(0);
+
+  YAML::Node Config = YAML::LoadFile(BenchmarkConfigName);
+  if (!Config["Benchmark"]) {
+    std::cerr << "Did not find the 'Benchmark' Node within the config:" << BenchmarkConfigName << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  YAML::Node Benchmark = Config["Benchmark"];
+
+  if (!Benchmark["Configs"]) {
+    std::cerr << "Expected to find a list of Oscillator configs in 'Benchmark''Configs'" << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  std::vector<std::string> ConfigNames = Benchmark["Configs"].as< std::vector<std::string> >();
+
+  std::unordered_map<std::string, FLOAT_T> GlobalParameters;
+  if (Benchmark["OscillationParameters"]) {
+    GlobalParameters = ReturnOscParamsFromConfig(YAML::LoadFile(Benchmark["OscillationParameters"].as<std::string>()));
+  }
+
+  std::vector< std::pair<int,int> > Grids;
+  if (Benchmark["Grids"]) {
+    for (auto Grid : Benchmark["Grids"]) {
+      int nEnergyPoints = Grid["EnergyPoints"] ? Grid["EnergyPoints"].as<int>() : 1000;
+      int nCosineZPoints = Grid["CosineZPoints"] ? Grid["CosineZPoints"].as<int>() : 1000;
+      Grids.push_back(std::make_pair(nEnergyPoints,nCosineZPoints));
+    }
+  } else {
+    Grids.push_back(std::make_pair(1000,1000));
+  }
+
+  std::vector<int> Threads = {0};
+  if (Benchmark["Threads"]) {
+    Threads = Benchmark["Threads"].as< std::vector<int> >();
+  }
+
+  std::vector<std::string> VariedParameters = {"delta_cp"};
+  if (Benchmark["VariedParameters"]) {
+    VariedParameters = Benchmark["VariedParameters"].as< std::vector<std::string> >();
+  }
+
+  int nWarmup = Benchmark["nWarmup"] ? Benchmark["nWarmup"].as<int>() : 5;
+  int nIterations = Benchmark["nIterations"] ? Benchmark["nIterations"].as<int>() : 100;
+  unsigned int Seed = Benchmark["Seed"] ? Benchmark["Seed"].as<unsigned int>() : 1234;
+
+  if (OutputName == "") {
+    OutputName = Benchmark["Output"] ? Benchmark["Output"].as<std::string>() : "NuOscillatorBench.json";
+  }
+
+  bool CountersEnabled = false;
+  std::vector<PerfCounterDefinition> CounterDefinitions;
+  if (Benchmark["PerfCounters"]) {
+    YAML::Node PerfCounters = Benchmark["PerfCounters"];
+    CountersEnabled = PerfCounters["Enabled"] ? PerfCounters["Enabled"].as<bool>() : true;
+    CounterDefinitions = ReturnDefaultPerfCounters();
+    if (PerfCounters["RawEvents"]) {
+      for (auto RawEvent : PerfCounters["RawEvents"]) {
+	CounterDefinitions.push_back(ReturnRawPerfCounter(RawEvent.first.as<std::string>(),RawEvent.second.as<std::string>()));
+      }
+    }
+  }
+
+  std::vector<BenchmarkRecord> Records;
+
+  for (size_t iConfig=0;iConfig<ConfigNames.size();iConfig++) {
+    std::vector<int> ThreadsBenchmarked;
+    for (size_t iThread=0;iThread<Threads.size();iThread++) {
+      SetBenchmarkThreads(Threads[iThread]);
+
+      for (size_t iGrid=0;iGrid<Grids.size();iGrid++) {
+	std::unordered_map<std::string, FLOAT_T> OscillationParameters;
+	OscillatorBase* Oscillator = CreateBenchmarkOscillator(ConfigNames[iConfig],Grids[iGrid].first,Grids[iGrid].second,GlobalParameters,OscillationParameters);
+	std::unordered_map<std::string, FLOAT_T> NominalParameters = OscillationParameters;
+
+	// Record the threads the engine actually runs on, which can be fewer than requested (e.g. single threaded engines). The default thread count may also
+	// coincide with one explicitly requested
+	int nThreads = Oscillator->ReturnNThreads();
+	if (iGrid == 0) {
+	  if (std::find(ThreadsBenchmarked.begin(),ThreadsBenchmarked.end(),nThreads) != ThreadsBenchmarked.end()) {
+	    delete Oscillator;
+	    break;
+	  }
+	  ThreadsBenchmarked.push_back(nThreads);
+	}
+
+	std::cout << "========================================================" << std::endl;
+	std::cout << "Benchmarking " << ConfigNames[iConfig] << " (Threads = " << nThreads << ", nEnergyPoints = " << Grids[iGrid].first << ", nCosineZPoints = " << Grids[iGrid].second << ")" << std::endl;
+
+	int nCosineZPoints = Oscillator->ReturnCosineZIgnored() ? 0 : Oscillator->ReturnNCosineZPoints();
+
+	for (size_t iPar=0;iPar<VariedParameters.size();iPar++) {
+	  OscillationParameterThrower Thrower(NominalParameters,VariedParameters[iPar],Seed);
+	  if (!Thrower.IsValid()) {
+	    std::cout << "Skipping varied parameter " << VariedParameters[iPar] << " which is not used by " << Oscillator->ReturnImplementationName() << std::endl;
+	    continue;
+	  }
+	  // Reset value by value, the Oscillator holds pointers to the entries of OscillationParameters
+	  for (auto Parameter : NominalParameters) {
+	    OscillationParameters[Parameter.first] = Parameter.second;
+	  }
+
+	  TimingSummary Summary = SummariseTimes(TimeReweights(Oscillator,Thrower,OscillationParameters,nWarmup,nIterations));
+	  std::cout << std::setw(20) << VariedParameters[iPar] << " : median " << Summary.Median << " ms [p5 " << Summary.P5 << ", p95 " << Summary.P95 << "], stddev " << Summary.StdDev << " ms" << std::endl;
+
+	  BenchmarkRecord Record;
+	  Record.Add("Config",ConfigNames[iConfig]);
+	  Record.Add("Implementation",Oscillator->ReturnImplementationName());
+	  Record.Add("nEnergyPoints",Oscillator->ReturnNEnergyPoints());
+	  Record.Add("nCosineZPoints",nCosineZPoints);
+	  Record.Add("Threads",nThreads);
+	  Record.Add("VariedParameter",VariedParameters[iPar]);
+	  Record.Add("nWarmup",nWarmup);
+	  Record.Add("nIterations",nIterations);
+	  Record.Add("Reweight",Summary);
+
+	  if (CountersEnabled) {
+	    StageCounters Counters = CountReweights(Oscillator,Thrower,OscillationParameters,nIterations,CounterDefinitions);
+	    AddStageCounters(Record,"Calcer",Counters.Calcer,CounterDefinitions);
+	    AddStageCounters(Record,"Post",Counters.Post,CounterDefinitions);
+	    Record.Add("PerfCounterThreads",Counters.nThreads);
+	    std::cout << "Hardware counters cover " << Counters.nThreads << " threads" << std::endl;
+	    for (size_t iCounter=0;iCounter<CounterDefinitions.size();iCounter++) {
+	      std::cout << std::setw(20) << CounterDefinitions[iCounter].Name << " : calcer " << Counters.Calcer[iCounter] << ", post " << Counters.Post[iCounter] << " per reweight" << std::endl;
+	    }
+	  }
+
+	  Records.push_back(Record);
+	}
+
+	bool EvalPointsFixed = Oscillator->EvalPointsSetInConstructor();
+	delete Oscillator;
+
+	// Binned Oscillators take their evaluation points from the config, so the grid sweep does not apply
+	if (EvalPointsFixed) break;
+      }
+    }
+  }
+
+  SetBenchmarkThreads(0);
+
+  WriteBenchmarkRecords(OutputName,"run",Records);
+  return 0;
+}
+
+// Median reweight time of a freshly created Oscillator, along with what is needed to label the result
+struct ScalingMeasurement {
+  std::string Implementation;
+  int nEnergyPoints;
+  int nCosineZPoints;
+  int nThreads;
+  bool EvalPointsFixed;
+  TimingSummary Summary;
+};
+
+ScalingMeasurement MeasureOscillator(const std::string& ConfigName, int nEnergyPoints, int nCosineZPoints, const std::unordered_map<std::string, FLOAT_T>& GlobalParameters,
+				     const std::string& VariedParameter, unsigned int Seed, int nWarmup, int nIterations) {
+  std::unordered_map<std::string, FLOAT_T> OscillationParameters;
+  OscillatorBase* Oscillator = CreateBenchmarkOscillator(ConfigName,nEnergyPoints,nCosineZPoints,GlobalParameters,OscillationParameters);
+
+  OscillationParameterThrower Thrower(OscillationParameters,VariedParameter,Seed);
+  if (!Thrower.IsValid()) {
+    std::cerr << "Varied parameter " << VariedParameter << " is not used by " << Oscillator->ReturnImplementationName() << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+
+  ScalingMeasurement Measurement;
+  Measurement.Summary = SummariseTimes(TimeReweights(Oscillator,Thrower,OscillationParameters,nWarmup,nIterations));
+  Measurement.Implementation = Oscillator->ReturnImplementationName();
+  Measurement.nEnergyPoints = Oscillator->ReturnNEnergyPoints();
+  Measurement.nCosineZPoints = Oscillator->ReturnCosineZIgnored() ? 0 : Oscillator->ReturnNCosineZPoints();
+  Measurement.nThreads = Oscillator->ReturnNThreads();
+  Measurement.EvalPointsFixed = Oscillator->EvalPointsSetInConstructor();
+
+  delete Oscillator;
+  return Measurement;
+}
+
+int RunScalingBenchmark(const std::string& BenchmarkConfigName, std::string OutputName) {
+  SetBenchmarkThreads(0);
+
+  YAML::Node Config = YAML::LoadFile(BenchmarkConfigName);
+  if (!Config["Benchmark"] || !Config["Benchmark"]["Configs"]) {
+    std::cerr << "Expected to find a list of Oscillator configs in 'Benchmark''Configs' within the config:" << BenchmarkConfigName << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  YAML::Node Benchmark = Config["Benchmark"];
+  YAML::Node Scaling = Benchmark["Scaling"];
+
+  std::vector<std::string> ConfigNames = Benchmark["Configs"].as< std::vector<std::string> >();
+
+  std::unordered_map<std::string, FLOAT_T> GlobalParameters;
+  if (Benchmark["OscillationParameters"]) {
+    GlobalParameters = ReturnOscParamsFromConfig(YAML::LoadFile(Benchmark["OscillationParameters"].as<std::string>()));
+  }
+
+  int nWarmup = Benchmark["nWarmup"] ? Benchmark["nWarmup"].as<int>() : 5;
+  int nIterations = Benchmark["nIterations"] ? Benchmark["nIterations"].as<int>() : 100;
+  unsigned int Seed = Benchmark["Seed"] ? Benchmark["Seed"].as<unsigned int>() : 1234;
+
+  std::string VariedParameter = (Scaling && Scaling["VariedParameter"]) ? Scaling["VariedParameter"].as<std::string>() : "All";
+  int nEnergyPoints = (Scaling && Scaling["EnergyPoints"]) ? Scaling["EnergyPoints"].as<int>() : 1000;
+  int nCosineZPoints = (Scaling && Scaling["CosineZPoints"]) ? Scaling["CosineZPoints"].as<int>() : 100;
+  int MaxThreads = (Scaling && Scaling["MaxThreads"]) ? Scaling["MaxThreads"].as<int>() : ReturnAvailableThreads();
+
+  // 1, 2, 4 ... up to and including MaxThreads
+  std::vector<int> Threads;
+  for (int nThreads=1;nThreads<MaxThreads;nThreads*=2) {
+    Threads.push_back(nThreads);
+  }
+  Threads.push_back(MaxThreads);
+
+  if (OutputName == "") {
+    OutputName = (Scaling && Scaling["Output"]) ? Scaling["Output"].as<std::string>() : "NuOscillatorScaling.json";
+  }
+
+  std::vector<BenchmarkRecord> Records;
+  std::vector<std::string> Summaries;
+
+  for (size_t iConfig=0;iConfig<ConfigNames.size();iConfig++) {
+    for (std::string Type : {"Strong","Weak"}) {
+      bool IsWeak = (Type == "Weak");
+      double SerialTime = -1;
+
+      for (size_t iThread=0;iThread<Threads.size();iThread++) {
+	int nThreads = SetBenchmarkThreads(Threads[iThread]);
+
+	// Weak scaling keeps the work per thread fixed by growing the energy grid with the thread count
+	int nEnergyPointsThisRun = IsWeak ? nEnergyPoints*nThreads : nEnergyPoints;
+
+	std::cout << "========================================================" << std::endl;
+	std::cout << Type << " scaling " << ConfigNames[iConfig] << " (Threads = " << nThreads << ", nEnergyPoints = " << nEnergyPointsThisRun << ", nCosineZPoints = " << nCosineZPoints << ")" << std::endl;
+
+	ScalingMeasurement Measurement = MeasureOscillator(ConfigNames[iConfig],nEnergyPointsThisRun,nCosineZPoints,GlobalParameters,VariedParameter,Seed,nWarmup,nIterations);
+	if (IsWeak && Measurement.EvalPointsFixed) {
+	  std::cout << "Skipping weak scaling of " << ConfigNames[iConfig] << " as its evaluation points are fixed by the config" << std::endl;
+	  break;
+	}
+	// Engines fixed to a thread count (e.g. single threaded ones, or a 'Threads' in their config) can not be scaled any further
+	if (Measurement.nThreads != nThreads) {
+	  std::cout << "Stopping " << Type << " scaling of " << ConfigNames[iConfig] << " as it runs on " << Measurement.nThreads << " rather than " << nThreads << " threads" << std::endl;
+	  break;
+	}
+
+	double Time = Measurement.Summary.Median;
+	if (iThread == 0) SerialTime = Time;
+
+	// Strong: speedup S = T1/TN and the Karp-Flatt serial fraction (1/S-1/N)/(1-1/N)
+	// Weak: scaled speedup S = N*T1/TN and the Gustafson serial fraction (N-S)/(N-1)
+	double Speedup = IsWeak ? nThreads*SerialTime/Time : SerialTime/Time;
+	double Efficiency = Speedup/nThreads;
+	double SerialFraction = 0.;
+	if (nThreads > 1) {
+	  SerialFraction = IsWeak ? (nThreads-Speedup)/(nThreads-1.) : (1./Speedup-1./nThreads)/(1.-1./nThreads);
+	}
+	std::cout << "Median " << Time << " ms, speedup " << Speedup << ", efficiency " << Efficiency << ", serial fraction " << SerialFraction << std::endl;
+
+	BenchmarkRecord Record;
+	Record.Add("Config",ConfigNames[iConfig]);
+	Record.Add("Implementation",Measurement.Implementation);
+	Record.Add("Scaling",Type);
+	Record.Add("nEnergyPoints",Measurement.nEnergyPoints);
+	Record.Add("nCosineZPoints",Measurement.nCosineZPoints);
+	Record.Add("Threads",nThreads);
+	Record.Add("VariedParameter",VariedParameter);
+	Record.Add("nWarmup",nWarmup);
+	Record.Add("nIterations",nIterations);
+	Record.Add("Reweight",Measurement.Summary);
+	Record.Add("Speedup",Speedup);
+	Record.Add("Efficiency",Efficiency);
+	Record.Add("SerialFraction",SerialFraction);
+	Records.push_back(Record);
+
+	std::ostringstream Line;
+	Line << std::setw(50) << ConfigNames[iConfig] << std::setw(8) << Type << std::setw(9) << nThreads << std::setw(15) << Time
+	     << std::setw(10) << Speedup << std::setw(12) << Efficiency << std::setw(16) << SerialFraction;
+	Summaries.push_back(Line.str());
+      }
+    }
+  }
+  SetBenchmarkThreads(0);
+
+  std::cout << "========================================================" << std::endl;
+  std::cout << std::setw(50) << "Config" << std::setw(8) << "Scaling" << std::setw(9) << "Threads" << std::setw(15) << "Median [ms]"
+	    << std::setw(10) << "Speedup" << std::setw(12) << "Efficiency" << std::setw(16) << "SerialFraction" << std::endl;
+  for (size_t iLine=0;iLine<Summaries.size();iLine++) {
+    std::cout << Summaries[iLine] << std::endl;
+  }
+  std::cout << "========================================================" << std::endl;
+
+  WriteBenchmarkRecords(OutputName,"scaling",Records);
+  return 0;
+}
+
+int RunSetupBenchmark(const std::string& BenchmarkConfigName, std::string OutputName) {
+  SetBenchmarkThreads(0);
+
+  YAML::Node Config = YAML::LoadFile(BenchmarkConfigName);
+  if (!Config["Benchmark"] || !Config["Benchmark"]["Configs"]) {
+    std::cerr << "Expected to find a list of Oscillator configs in 'Benchmark''Configs' within the config:" << BenchmarkConfigName << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  YAML::Node Benchmark = Config["Benchmark"];
+  YAML::Node Setup = Benchmark["Setup"];
+
+  std::vector<std::string> ConfigNames = Benchmark["Configs"].as< std::vector<std::string> >();
+
+  std::unordered_map<std::string, FLOAT_T> GlobalParameters;
+  if (Benchmark["OscillationParameters"]) {
+    GlobalParameters = ReturnOscParamsFromConfig(YAML::LoadFile(Benchmark["OscillationParameters"].as<std::string>()));
+  }
+
+  std::vector< std::pair<int,int> > Grids;
+  if (Benchmark["Grids"]) {
+    for (auto Grid : Benchmark["Grids"]) {
+      int nEnergyPoints = Grid["EnergyPoints"] ? Grid["EnergyPoints"].as<int>() : 1000;
+      int nCosineZPoints = Grid["CosineZPoints"] ? Grid["CosineZPoints"].as<int>() : 1000;
+      Grids.push_back(std::make_pair(nEnergyPoints,nCosineZPoints));
+    }
+  } else {
+    Grids.push_back(std::make_pair(1000,1000));
+  }
+
+  // Setup is a one-off cost, so repeat it a few times and keep the distribution
+  int nRepeats = (Setup && Setup["nRepeats"]) ? Setup["nRepeats"].as<int>() : 3;
+
+  if (OutputName == "") {
+    OutputName = (Setup && Setup["Output"]) ? Setup["Output"].as<std::string>() : "NuOscillatorSetup.json";
+  }
+
+  const std::vector<std::string> PhaseNames = {"Construct","SetEvalPoints","DefineParameters","Setup","FirstReweight"};
+
+  std::vector<BenchmarkRecord> Records;
+
+  for (size_t iConfig=0;iConfig<ConfigNames.size();iConfig++) {
+    for (size_t iGrid=0;iGrid<Grids.size();iGrid++) {
+      std::cout << "========================================================" << std::endl;
+      std::cout << "Timing setup of " << ConfigNames[iConfig] << " (nEnergyPoints = " << Grids[iGrid].first << ", nCosineZPoints = " << Grids[iGrid].second << ")" << std::endl;
+
+      std::vector< std::vector<double> > PhaseTimes(PhaseNames.size());
+      std::vector<double> TotalTimes;
+      std::vector<long> PhaseRSSKB(PhaseNames.size(),0);
+      long PeakRSSKB = -1;
+      bool PeakRSSIsolated = false;
+
+      std::string Implementation;
+      int nEnergyPoints = 0;
+      int nCosineZPoints = 0;
+      long WeightArrayBytes = 0;
+      long LookupTableBytes = 0;
+      bool EvalPointsFixed = false;
+
+      for (int iRepeat=0;iRepeat<nRepeats;iRepeat++) {
+	PeakRSSIsolated = ResetPeakRSS();
+	long RSSBefore = ReturnCurrentRSSKB();
+	std::vector<double> Times;
+	std::vector<long> RSSAfter;
+
+	auto Start = high_resolution_clock::now();
+	auto Last = Start;
+	auto EndPhase = [&]() {
+	  auto Now = high_resolution_clock::now();
+	  duration<double, std::milli> ms_double = Now-Last;
+	  Times.push_back(ms_double.count());
+	  RSSAfter.push_back(ReturnCurrentRSSKB());
+	  Last = Now;
+	};
+
+	OscillatorFactory* OscFactory = new OscillatorFactory();
+	OscillatorBase* Oscillator = OscFactory->CreateOscillator(ConfigNames[iConfig]);
+	delete OscFactory;
+	EndPhase();
+
+	if (!Oscillator->EvalPointsSetInConstructor()) {
+	  Oscillator->SetEnergyArrayInCalcer(logspace(0.1,100.,Grids[iGrid].first));
+	  if (!Oscillator->ReturnCosineZIgnored()) {
+	    Oscillator->SetCosineZArrayInCalcer(linspace(-1.0,1.0,Grids[iGrid].second));
+	  }
+	}
+	EndPhase();
+
+	std::unordered_map<std::string, FLOAT_T> OscillationParameters = ReturnOscParamsFromConfig(YAML::LoadFile(ConfigNames[iConfig]));
+	for (auto Parameter : GlobalParameters) {
+	  if (OscillationParameters.count(Parameter.first)) {
+	    OscillationParameters[Parameter.first] = Parameter.second;
+	  }
+	}
+	for (auto Parameter : OscillationParameters) {
+	  Oscillator->DefineParameter(Parameter.first, &OscillationParameters[Parameter.first]);
+	}
+	EndPhase();
+
+	Oscillator->Setup();
+	EndPhase();
+
+	// Some engines defer allocations to the first calculation
+	Oscillator->CalculateProbabilities();
+	EndPhase();
+
+	duration<double, std::milli> ms_total = Last-Start;
+	TotalTimes.push_back(ms_total.count());
+	for (size_t iPhase=0;iPhase<PhaseNames.size();iPhase++) {
+	  PhaseTimes[iPhase].push_back(Times[iPhase]);
+	  // Later repeats reuse memory freed by the first, so only its RSS growth is meaningful
+	  if (iRepeat == 0) PhaseRSSKB[iPhase] = RSSAfter[iPhase]-(iPhase == 0 ? RSSBefore : RSSAfter[iPhase-1]);
+	}
+	PeakRSSKB = std::max(PeakRSSKB,ReturnPeakRSSKB());
+
+	Implementation = Oscillator->ReturnImplementationName();
+	nEnergyPoints = Oscillator->ReturnNEnergyPoints();
+	nCosineZPoints = Oscillator->ReturnCosineZIgnored() ? 0 : Oscillator->ReturnNCosineZPoints();
+	WeightArrayBytes = Oscillator->ReturnWeightArrayBytes();
+	LookupTableBytes = Oscillator->ReturnLookupTableBytes();
+	EvalPointsFixed = Oscillator->EvalPointsSetInConstructor();
+
+	delete Oscillator;
+      }
+
+      BenchmarkRecord Record;
+      Record.Add("Config",ConfigNames[iConfig]);
+      Record.Add("Implementation",Implementation);
+      Record.Add("nEnergyPoints",nEnergyPoints);
+      Record.Add("nCosineZPoints",nCosineZPoints);
+      Record.Add("nRepeats",nRepeats);
+      for (size_t iPhase=0;iPhase<PhaseNames.size();iPhase++) {
+	TimingSummary Summary = SummariseTimes(PhaseTimes[iPhase]);
+	Record.Add(PhaseNames[iPhase]+"Median_ms",Summary.Median);
+	Record.Add(PhaseNames[iPhase]+"Max_ms",Summary.Max);
+	std::cout << std::setw(20) << PhaseNames[iPhase] << " : median " << Summary.Median << " ms, RSS change " << PhaseRSSKB[iPhase] << " kB" << std::endl;
+      }
+      Record.Add("Total",SummariseTimes(TotalTimes));
+      for (size_t iPhase=0;iPhase<PhaseNames.size();iPhase++) {
+	Record.Add(PhaseNames[iPhase]+"RSSChange_kB",PhaseRSSKB[iPhase]);
+      }
+      // Without a peak reset the peak covers everything the process did before this entry
+      Record.Add("PeakRSS_kB",PeakRSSKB);
+      Record.Add("PeakRSSIsolated",(long)PeakRSSIsolated);
+      Record.Add("WeightArrayBytes",WeightArrayBytes);
+      Record.Add("LookupTableBytes",LookupTableBytes);
+      Records.push_back(Record);
+
+      std::cout << "Weight arrays: " << WeightArrayBytes << " bytes, lookup tables: " << LookupTableBytes << " bytes, peak RSS: " << PeakRSSKB << " kB" << (PeakRSSIsolated ? "" : " (not isolated)") << std::endl;
+
+      // Binned Oscillators take their evaluation points from the config, so the grid sweep does not apply
+      if (EvalPointsFixed) break;
+    }
+  }
+
+  WriteBenchmarkRecords(OutputName,"setup",Records);
+  return 0;
+}
+
+// A single probability which is compared between a candidate and its reference
+struct ProbabilityPoint {
+  int InitNuFlav;
+  int FinalNuFlav;
+  FLOAT_T Energy;
+  FLOAT_T CosineZ;
+};
+
+// Every probability evaluated by Layout for the channels which Reference also calculates
+std::vector<ProbabilityPoint> ReturnProbabilityPoints(OscillatorBase* Layout, OscillatorBase* Reference) {
+  std::vector<ProbabilityPoint> Points;
+
+  std::vector<FLOAT_T> Energies = Layout->ReturnEnergyArray();
+  std::vector<FLOAT_T> CosineZs = {DUMMYVAL};
+  if (!Layout->ReturnCosineZIgnored()) {
+    CosineZs = Layout->ReturnCosineZArray();
+  }
+
+  std::vector<NuOscillator::OscillationChannel> Channels = Layout->ReturnOscChannels();
+  for (int NuType : Layout->ReturnNeutrinoTypes()) {
+    for (size_t iChannel=0;iChannel<Channels.size();iChannel++) {
+      if (!Reference->HasOscProbCalcerGotOscillationChannel(Channels[iChannel].GeneratedFlavour,Channels[iChannel].DetectedFlavour)) continue;
+
+      for (size_t iEnergy=0;iEnergy<Energies.size();iEnergy++) {
+	for (size_t iCosineZ=0;iCosineZ<CosineZs.size();iCosineZ++) {
+	  ProbabilityPoint Point;
+	  Point.InitNuFlav = NuType*Channels[iChannel].GeneratedFlavour;
+	  Point.FinalNuFlav = NuType*Channels[iChannel].DetectedFlavour;
+	  Point.Energy = Energies[iEnergy];
+	  Point.CosineZ = CosineZs[iCosineZ];
+	  Points.push_back(Point);
+	}
+      }
+    }
+  }
+
+  return Points;
+}
+
+std::vector<const FLOAT_T*> ReturnProbabilityPointers(OscillatorBase* Oscillator, const std::vector<ProbabilityPoint>& Points) {
+  std::vector<const FLOAT_T*> Pointers(Points.size());
+  for (size_t iPoint=0;iPoint<Points.size();iPoint++) {
+    Pointers[iPoint] = Oscillator->ReturnWeightPointer(Points[iPoint].InitNuFlav,Points[iPoint].FinalNuFlav,Points[iPoint].Energy,Points[iPoint].CosineZ);
+  }
+  return Pointers;
+}
+
+// Result of one engine setting in the accuracy-versus-cost sweep
+struct ParetoPoint {
+  std::string Group;
+  std::string Label;
+  double Time;
+  double MaxDeviation;
+  bool OnFront;
+};
+
+int RunParetoBenchmark(const std::string& BenchmarkConfigName, std::string OutputName) {
+  SetBenchmarkThreads(0);
+
+  YAML::Node Config = YAML::LoadFile(BenchmarkConfigName);
+  if (!Config["Benchmark"] || !Config["Benchmark"]["Pareto"] || !Config["Benchmark"]["Pareto"]["Candidates"]) {
+    std::cerr << "Expected to find a list of candidates in 'Benchmark''Pareto''Candidates' within the config:" << BenchmarkConfigName << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  YAML::Node Benchmark = Config["Benchmark"];
+  YAML::Node Pareto = Benchmark["Pareto"];
+
+  std::unordered_map<std::string, FLOAT_T> GlobalParameters;
+  if (Benchmark["OscillationParameters"]) {
+    GlobalParameters = ReturnOscParamsFromConfig(YAML::LoadFile(Benchmark["OscillationParameters"].as<std::string>()));
+  }
+
+  int nWarmup = Benchmark["nWarmup"] ? Benchmark["nWarmup"].as<int>() : 5;
+  unsigned int Seed = Benchmark["Seed"] ? Benchmark["Seed"].as<unsigned int>() : 1234;
+
+  int nThrows = Pareto["nThrows"] ? Pareto["nThrows"].as<int>() : 20;
+  std::string VariedParameter = Pareto["VariedParameter"] ? Pareto["VariedParameter"].as<std::string>() : "All";
+  int nEnergyPoints = Pareto["EnergyPoints"] ? Pareto["EnergyPoints"].as<int>() : 200;
+  int nCosineZPoints = Pareto["CosineZPoints"] ? Pareto["CosineZPoints"].as<int>() : 50;
+  double Tolerance = Pareto["Tolerance"] ? Pareto["Tolerance"].as<double>() : -1.;
+
+  if (nThrows < 1) {
+    std::cerr << "'Benchmark''Pareto''nThrows' must be at least 1, got:" << nThrows << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+
+  if (OutputName == "") {
+    OutputName = Pareto["Output"] ? Pareto["Output"].as<std::string>() : "NuOscillatorPareto.json";
+  }
+
+  std::vector<BenchmarkRecord> Records;
+  std::vector<ParetoPoint> Points;
+
+  for (auto Candidate : Pareto["Candidates"]) {
+    if (!Candidate["Config"]) {
+      std::cerr << "Each entry of 'Benchmark''Pareto''Candidates' needs a 'Config'" << std::endl;
+      throw std::runtime_error("Invalid setup");
+    }
+    std::string ConfigName = Candidate["Config"].as<std::string>();
+    std::string Knob = Candidate["Knob"] ? Candidate["Knob"].as<std::string>() : "";
+    std::vector<YAML::Node> KnobValues;
+    if (Knob != "" && Candidate["Values"]) {
+      for (auto Value : Candidate["Values"]) {
+	KnobValues.push_back(Value);
+      }
+    } else {
+      KnobValues.push_back(YAML::Node());
+    }
+
+    // The reference defaults to the candidate engine itself, with its OscProbCalcerSetup tightened by ReferenceSettings
+    std::string ReferenceName = Candidate["Reference"] ? Candidate["Reference"].as<std::string>() : ConfigName;
+    YAML::Node ReferenceConfig = YAML::LoadFile(ReferenceName);
+    std::string Group = ReferenceName;
+    if (Candidate["ReferenceSettings"]) {
+      for (auto Setting : Candidate["ReferenceSettings"]) {
+	ReferenceConfig["OscProbCalcerSetup"][Setting.first.as<std::string>()] = Setting.second;
+	Group += " "+Setting.first.as<std::string>()+"="+Setting.second.as<std::string>();
+      }
+    }
+
+    std::cout << "========================================================" << std::endl;
+    std::cout << "Calculating reference " << Group << std::endl;
+
+    std::unordered_map<std::string, FLOAT_T> ReferenceParameters;
+    OscillatorBase* Reference = CreateBenchmarkOscillator(ReferenceConfig,nEnergyPoints,nCosineZPoints,GlobalParameters,ReferenceParameters);
+
+    std::vector<ProbabilityPoint> ProbabilityPoints;
+    std::vector< std::unordered_map<std::string, FLOAT_T> > Throws;
+    std::vector< std::vector<FLOAT_T> > ReferenceProbabilities;
+
+    for (size_t iValue=0;iValue<KnobValues.size();iValue++) {
+      YAML::Node CandidateConfig = YAML::LoadFile(ConfigName);
+      std::string KnobValue = KnobValues[iValue].IsDefined() ? KnobValues[iValue].as<std::string>() : "";
+      if (Knob != "") {
+	CandidateConfig["OscProbCalcerSetup"][Knob] = KnobValues[iValue];
+      }
+
+      std::cout << "========================================================" << std::endl;
+      std::cout << "Benchmarking " << ConfigName << (Knob != "" ? " with "+Knob+"="+KnobValue : "") << std::endl;
+
+      std::unordered_map<std::string, FLOAT_T> OscillationParameters;
+      OscillatorBase* Oscillator = CreateBenchmarkOscillator(CandidateConfig,nEnergyPoints,nCosineZPoints,GlobalParameters,OscillationParameters);
+
+      // The throws and reference probabilities only depend on the grid and channels, so they are shared by every knob value
+      if (iValue == 0) {
+	ProbabilityPoints = ReturnProbabilityPoints(Oscillator,Reference);
+	std::vector<const FLOAT_T*> ReferencePointers = ReturnProbabilityPointers(Reference,ProbabilityPoints);
+
+	OscillationParameterThrower Thrower(OscillationParameters,VariedParameter,Seed);
+	if (!Thrower.IsValid()) {
+	  std::cerr << "Varied parameter " << VariedParameter << " is not used by " << Oscillator->ReturnImplementationName() << std::endl;
+	  throw std::runtime_error("Invalid setup");
+	}
+
+	std::unordered_map<std::string, FLOAT_T> Nominal = OscillationParameters;
+	for (int iThrow=0;iThrow<nThrows;iThrow++) {
+	  std::unordered_map<std::string, FLOAT_T> Throw = Nominal;
+	  Thrower.Throw(Throw);
+	  Throws.push_back(Throw);
+
+	  // Only parameters shared by name are propagated to the reference
+	  for (auto Parameter : Throw) {
+	    if (ReferenceParameters.count(Parameter.first)) {
+	      ReferenceParameters[Parameter.first] = Parameter.second;
+	    }
+	  }
+	  Reference->CalculateProbabilities();
+
+	  std::vector<FLOAT_T> Probabilities(ReferencePointers.size());
+	  for (size_t iPoint=0;iPoint<ReferencePointers.size();iPoint++) {
+	    Probabilities[iPoint] = *ReferencePointers[iPoint];
+	  }
+	  ReferenceProbabilities.push_back(Probabilities);
+	}
+      }
+      std::vector<const FLOAT_T*> Pointers = ReturnProbabilityPointers(Oscillator,ProbabilityPoints);
+
+      for (int iWarmup=0;iWarmup<nWarmup;iWarmup++) {
+	for (auto Parameter : Throws[iWarmup%nThrows]) {
+	  OscillationParameters[Parameter.first] = Parameter.second;
+	}
+	Oscillator->CalculateProbabilities();
+      }
+
+      std::vector<double> Times(nThrows);
+      double MaxDeviation = 0.;
+      double SumSquaredDeviation = 0.;
+      for (int iThrow=0;iThrow<nThrows;iThrow++) {
+	for (auto Parameter : Throws[iThrow]) {
+	  OscillationParameters[Parameter.first] = Parameter.second;
+	}
+
+	auto t1 = high_resolution_clock::now();
+	Oscillator->CalculateProbabilities();
+	auto t2 = high_resolution_clock::now();
+	duration<double, std::milli> ms_double = t2-t1;
+	Times[iThrow] = ms_double.count();
+
+	for (size_t iPoint=0;iPoint<Pointers.size();iPoint++) {
+	  double Deviation = fabs(*Pointers[iPoint]-ReferenceProbabilities[iThrow][iPoint]);
+	  MaxDeviation = std::max(MaxDeviation,Deviation);
+	  SumSquaredDeviation += Deviation*Deviation;
+	}
+      }
+      double RMSDeviation = sqrt(SumSquaredDeviation/std::max((double)nThrows*Pointers.size(),1.));
+
+      TimingSummary Summary = SummariseTimes(Times);
+      std::cout << "Median " << Summary.Median << " ms, max |dP| " << MaxDeviation << ", RMS dP " << RMSDeviation << std::endl;
+
+      BenchmarkRecord Record;
+      Record.Add("Config",ConfigName);
+      Record.Add("Implementation",Oscillator->ReturnImplementationName());
+      Record.Add("Knob",Knob);
+      Record.Add("KnobValue",KnobValue);
+      Record.Add("Reference",Group);
+      Record.Add("nEnergyPoints",Oscillator->ReturnNEnergyPoints());
+      Record.Add("nCosineZPoints",Oscillator->ReturnCosineZIgnored() ? 0 : Oscillator->ReturnNCosineZPoints());
+      Record.Add("VariedParameter",VariedParameter);
+      Record.Add("nThrows",nThrows);
+      Record.Add("Reweight",Summary);
+      Record.Add("MaxDeviation",MaxDeviation);
+      Record.Add("RMSDeviation",RMSDeviation);
+      Records.push_back(Record);
+
+      ParetoPoint Point;
+      Point.Group = Group;
+      Point.Label = ConfigName+(Knob != "" ? " "+Knob+"="+KnobValue : "");
+      Point.Time = Summary.Median;
+      Point.MaxDeviation = MaxDeviation;
+      Point.OnFront = true;
+      Points.push_back(Point);
+
+      delete Oscillator;
+    }
+
+    delete Reference;
+  }
+
+  // A setting is on the front if no other setting compared to the same reference is at least as fast and as accurate, and strictly better in one
+  for (size_t iPoint=0;iPoint<Points.size();iPoint++) {
+    for (size_t jPoint=0;jPoint<Points.size();jPoint++) {
+      if (iPoint == jPoint || Points[iPoint].Group != Points[jPoint].Group) continue;
+      bool NoWorse = Points[jPoint].Time <= Points[iPoint].Time && Points[jPoint].MaxDeviation <= Points[iPoint].MaxDeviation;
+      bool Better = Points[jPoint].Time < Points[iPoint].Time || Points[jPoint].MaxDeviation < Points[iPoint].MaxDeviation;
+      if (NoWorse && Better) {
+	Points[iPoint].OnFront = false;
+	break;
+      }
+    }
+    Records[iPoint].Add("OnParetoFront",(long)Points[iPoint].OnFront);
+    if (Tolerance > 0) {
+      Records[iPoint].Add("MeetsTolerance",(long)(Points[iPoint].MaxDeviation <= Tolerance));
+    }
+  }
+
+  std::vector<std::string> Groups;
+  for (size_t iPoint=0;iPoint<Points.size();iPoint++) {
+    if (std::find(Groups.begin(),Groups.end(),Points[iPoint].Group) == Groups.end()) Groups.push_back(Points[iPoint].Group);
+  }
+
+  for (size_t iGroup=0;iGroup<Groups.size();iGroup++) {
+    std::vector<ParetoPoint> Front;
+    for (size_t iPoint=0;iPoint<Points.size();iPoint++) {
+      if (Points[iPoint].Group == Groups[iGroup] && Points[iPoint].OnFront) Front.push_back(Points[iPoint]);
+    }
+    std::sort(Front.begin(),Front.end(),[](const ParetoPoint& a, const ParetoPoint& b) {return a.Time < b.Time;});
+
+    std::cout << "========================================================" << std::endl;
+    std::cout << "Pareto front against reference: " << Groups[iGroup] << std::endl;
+    std::cout << std::setw(70) << "Setting" << std::setw(15) << "Median [ms]" << std::setw(15) << "Max |dP|" << std::endl;
+    for (size_t iPoint=0;iPoint<Front.size();iPoint++) {
+      std::cout << std::setw(70) << Front[iPoint].Label << std::setw(15) << Front[iPoint].Time << std::setw(15) << Front[iPoint].MaxDeviation << std::endl;
+    }
+
+    if (Tolerance > 0) {
+      // The front is sorted by time, so the first entry within tolerance is the cheapest
+      bool Found = false;
+      for (size_t iPoint=0;iPoint<Front.size() && !Found;iPoint++) {
+	if (Front[iPoint].MaxDeviation <= Tolerance) {
+	  std::cout << "Cheapest setting with max |dP| <= " << Tolerance << ": " << Front[iPoint].Label << std::endl;
+	  Found = true;
+	}
+      }
+      if (!Found) {
+	std::cout << "No setting reaches max |dP| <= " << Tolerance << std::endl;
+      }
+    }
+  }
+  std::cout << "========================================================" << std::endl;
+
+  WriteBenchmarkRecords(OutputName,"pareto",Records);
+  return 0;
+}
+
+// A synthetic event passed to ReturnWeightPointer
+struct LookupEvent {
+  int InitNuFlav;
+  int FinalNuFlav;
+  FLOAT_T Energy;
+  FLOAT_T CosineZ;
+};
+
+/**
+ * Generates synthetic events within the axes of an Oscillator:
+ *   "Uniform"    - energy and cosine zenith uniform over the axes
+ *   "Clustered"  - energy gaussian in log(E) around a peak at a quarter of the axis, cosine zenith gaussian around the horizon, as in a real sample
+ *   "OutOfRange" - energy above the last bin edge, so every lookup takes the exception path
+ * Events for Oscillators whose evaluation points are not set in the constructor (unbinned) are moved to the closest evaluation point
+ */
+class LookupEventGenerator {
+ public:
+  LookupEventGenerator(OscillatorBase* Oscillator, const std::string& Distribution_, unsigned int Seed) : Distribution(Distribution_), Generator(Seed), Uniform(0.,1.), Gaussian(0.,1.) {
+    if (Distribution != "Uniform" && Distribution != "Clustered" && Distribution != "OutOfRange") {
+      std::cerr << "Unknown event distribution:" << Distribution << " - Expected one of Uniform, Clustered or OutOfRange" << std::endl;
+      throw std::runtime_error("Invalid setup");
+    }
+
+    std::vector<FLOAT_T> EnergyEdges = Oscillator->ReturnBinEdgesForPlotting(true);
+    EnergyMin = EnergyEdges.front();
+    EnergyMax = EnergyEdges.back();
+
+    CosineZIgnored = Oscillator->ReturnCosineZIgnored();
+    if (!CosineZIgnored) {
+      std::vector<FLOAT_T> CosineZEdges = Oscillator->ReturnBinEdgesForPlotting(false);
+      CosineZMin = CosineZEdges.front();
+      CosineZMax = CosineZEdges.back();
+    }
+
+    SnapToEvalPoints = !Oscillator->EvalPointsSetInConstructor();
+    if (SnapToEvalPoints) {
+      EnergyEvalPoints = Oscillator->ReturnEnergyArray();
+      if (!CosineZIgnored) CosineZEvalPoints = Oscillator->ReturnCosineZArray();
+    }
+
+    std::vector<NuOscillator::OscillationChannel> Channels = Oscillator->ReturnOscChannels();
+    for (int NuType : Oscillator->ReturnNeutrinoTypes()) {
+      for (size_t iChannel=0;iChannel<Channels.size();iChannel++) {
+	Flavours.push_back(std::make_pair(NuType*Channels[iChannel].GeneratedFlavour,NuType*Channels[iChannel].DetectedFlavour));
+      }
+    }
+  }
+
+  void Generate(std::vector<LookupEvent>& Events) {
+    for (size_t iEvent=0;iEvent<Events.size();iEvent++) {
+      std::pair<int,int> Flavour = Flavours[(size_t)(Uniform(Generator)*Flavours.size())%Flavours.size()];
+      Events[iEvent].InitNuFlav = Flavour.first;
+      Events[iEvent].FinalNuFlav = Flavour.second;
+
+      if (Distribution == "Clustered") {
+	Events[iEvent].Energy = ThrowClusteredEnergy();
+	Events[iEvent].CosineZ = CosineZIgnored ? DUMMYVAL : ThrowClusteredCosineZ();
+      } else {
+	Events[iEvent].Energy = EnergyMin+(EnergyMax-EnergyMin)*Uniform(Generator);
+	Events[iEvent].CosineZ = CosineZIgnored ? DUMMYVAL : CosineZMin+(CosineZMax-CosineZMin)*Uniform(Generator);
+      }
+
+      if (SnapToEvalPoints) {
+	Events[iEvent].Energy = ReturnClosestEvalPoint(EnergyEvalPoints,Events[iEvent].Energy);
+	if (!CosineZIgnored) Events[iEvent].CosineZ = ReturnClosestEvalPoint(CosineZEvalPoints,Events[iEvent].CosineZ);
+      }
+
+      if (Distribution == "OutOfRange") {
+	Events[iEvent].Energy = EnergyMax+(EnergyMax-EnergyMin)*(0.1+Uniform(Generator));
+      }
+    }
+  }
+
+ private:
+  // Gaussian in log(E) centred a quarter of the way along the axis, resampled until it falls within the axis
+  FLOAT_T ThrowClusteredEnergy() {
+    bool LogScale = EnergyMin > 0.;
+    FLOAT_T Min = LogScale ? log(EnergyMin) : EnergyMin;
+    FLOAT_T Max = LogScale ? log(EnergyMax) : EnergyMax;
+    FLOAT_T Value;
+    do {
+      Value = Min+(Max-Min)*(0.25+0.1*Gaussian(Generator));
+    } while (Value < Min || Value >= Max);
+    return LogScale ? exp(Value) : Value;
+  }
+
+  // Gaussian around the horizon with a width of 15% of the axis, resampled until it falls within the axis
+  FLOAT_T ThrowClusteredCosineZ() {
+    FLOAT_T Value;
+    do {
+      Value = 0.5*(CosineZMin+CosineZMax)+0.15*(CosineZMax-CosineZMin)*Gaussian(Generator);
+    } while (Value < CosineZMin || Value >= CosineZMax);
+    return Value;
+  }
+
+  static FLOAT_T ReturnClosestEvalPoint(const std::vector<FLOAT_T>& EvalPoints, FLOAT_T Value) {
+    auto it = std::lower_bound(EvalPoints.begin(),EvalPoints.end(),Value);
+    if (it == EvalPoints.end()) return EvalPoints.back();
+    if (it == EvalPoints.begin()) return EvalPoints.front();
+    return (*it-Value < Value-*(it-1)) ? *it : *(it-1);
+  }
+
+  std::string Distribution;
+  std::mt19937 Generator;
+  std::uniform_real_distribution<double> Uniform;
+  std::normal_distribution<double> Gaussian;
+
+  FLOAT_T EnergyMin, EnergyMax;
+  FLOAT_T CosineZMin = DUMMYVAL, CosineZMax = DUMMYVAL;
+  bool CosineZIgnored;
+
+  bool SnapToEvalPoints;
+  std::vector<FLOAT_T> EnergyEvalPoints;
+  std::vector<FLOAT_T> CosineZEvalPoints;
+
+  std::vector< std::pair<int,int> > Flavours;
+};
+
+// Discards everything written to it, while still paying for the formatting
+class NullStreamBuffer : public std::streambuf {
+ protected:
+  int overflow(int Character) override {return Character;}
+};
+
+int RunLookupBenchmark(const std::string& BenchmarkConfigName, std::string OutputName) {
+  SetBenchmarkThreads(0);
+
+  YAML::Node Config = YAML::LoadFile(BenchmarkConfigName);
+  if (!Config["Benchmark"] || !Config["Benchmark"]["Lookup"]) {
+    std::cerr << "Did not find the 'Benchmark''Lookup' Node within the config:" << BenchmarkConfigName << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  YAML::Node Benchmark = Config["Benchmark"];
+  YAML::Node Lookup = Benchmark["Lookup"];
+
+  if (!Lookup["Configs"]) {
+    std::cerr << "Expected to find a list of Oscillator configs in 'Benchmark''Lookup''Configs'" << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  std::vector<std::string> ConfigNames = Lookup["Configs"].as< std::vector<std::string> >();
+
+  std::unordered_map<std::string, FLOAT_T> GlobalParameters;
+  if (Benchmark["OscillationParameters"]) {
+    GlobalParameters = ReturnOscParamsFromConfig(YAML::LoadFile(Benchmark["OscillationParameters"].as<std::string>()));
+  }
+
+  std::vector<long> nEvents = {10000, 100000, 1000000, 10000000, 100000000};
+  if (Lookup["nEvents"]) {
+    nEvents = Lookup["nEvents"].as< std::vector<long> >();
+  }
+
+  std::vector<std::string> Distributions = {"Uniform", "Clustered", "OutOfRange"};
+  if (Lookup["Distributions"]) {
+    Distributions = Lookup["Distributions"].as< std::vector<std::string> >();
+  }
+
+  // Used by unbinned Oscillators, binned Oscillators take their axes from the config
+  int nEnergyPoints = Lookup["EnergyPoints"] ? Lookup["EnergyPoints"].as<int>() : 1000;
+  int nCosineZPoints = Lookup["CosineZPoints"] ? Lookup["CosineZPoints"].as<int>() : 1000;
+  int nRepeats = Lookup["nRepeats"] ? Lookup["nRepeats"].as<int>() : 3;
+  // Each failed lookup writes a diagnostic to std::cerr and throws, so the exception path is limited to this many lookups
+  long MaxExceptionLookups = Lookup["MaxExceptionLookups"] ? Lookup["MaxExceptionLookups"].as<long>() : 100000;
+  // Events are generated in chunks of this size so that 1e8 events do not need to be held in memory
+  long ChunkSize = Lookup["ChunkSize"] ? Lookup["ChunkSize"].as<long>() : 1000000;
+  unsigned int Seed = Benchmark["Seed"] ? Benchmark["Seed"].as<unsigned int>() : 1234;
+
+  if (OutputName == "") {
+    OutputName = Lookup["Output"] ? Lookup["Output"].as<std::string>() : "NuOscillatorLookup.json";
+  }
+
+  std::vector<BenchmarkRecord> Records;
+  NullStreamBuffer NullBuffer;
+
+  for (size_t iConfig=0;iConfig<ConfigNames.size();iConfig++) {
+    YAML::Node OscillatorConfig = YAML::LoadFile(ConfigNames[iConfig]);
+    std::string CalculationType = OscillatorConfig["General"]["CalculationType"].as<std::string>();
+
+    std::unordered_map<std::string, FLOAT_T> OscillationParameters;
+    OscillatorBase* Oscillator = CreateBenchmarkOscillator(OscillatorConfig,nEnergyPoints,nCosineZPoints,GlobalParameters,OscillationParameters);
+    Oscillator->CalculateProbabilities();
+
+    for (size_t iDist=0;iDist<Distributions.size();iDist++) {
+      bool ExceptionPath = (Distributions[iDist] == "OutOfRange");
+
+      for (size_t iEvents=0;iEvents<nEvents.size();iEvents++) {
+	long nLookups = ExceptionPath ? std::min(nEvents[iEvents],MaxExceptionLookups) : nEvents[iEvents];
+
+	std::cout << "========================================================" << std::endl;
+	std::cout << "Lookups in " << ConfigNames[iConfig] << " (" << CalculationType << ", " << Distributions[iDist] << ", nEvents = " << nEvents[iEvents] << ")" << std::endl;
+
+	// The same events are looked up in every repeat, the time of each repeat is summed over chunks
+	LookupEventGenerator EventGenerator(Oscillator,Distributions[iDist],Seed);
+	std::vector<double> Times(nRepeats,0.);
+	long nExceptions = 0;
+	uintptr_t Sink = 0;
+
+	std::streambuf* CerrBuffer = std::cerr.rdbuf();
+	if (ExceptionPath) std::cerr.rdbuf(&NullBuffer);
+
+	for (long iFirst=0;iFirst<nLookups;iFirst+=ChunkSize) {
+	  std::vector<LookupEvent> Events(std::min(ChunkSize,nLookups-iFirst));
+	  EventGenerator.Generate(Events);
+
+	  for (int iRepeat=0;iRepeat<nRepeats;iRepeat++) {
+	    auto t1 = high_resolution_clock::now();
+	    for (size_t iEvent=0;iEvent<Events.size();iEvent++) {
+	      try {
+		Sink ^= (uintptr_t)Oscillator->ReturnWeightPointer(Events[iEvent].InitNuFlav,Events[iEvent].FinalNuFlav,Events[iEvent].Energy,Events[iEvent].CosineZ);
+	      } catch (std::runtime_error& Error) {
+		nExceptions++;
+	      }
+	    }
+	    auto t2 = high_resolution_clock::now();
+	    duration<double, std::milli> ms_double = t2-t1;
+	    Times[iRepeat] += ms_double.count();
+	  }
+	}
+
+	std::cerr.rdbuf(CerrBuffer);
+	nExceptions /= nRepeats;
+
+	TimingSummary Summary = SummariseTimes(Times);
+	double LookupsPerSecond = Summary.Median > 0. ? nLookups/(Summary.Median*1e-3) : 0.;
+	double NsPerLookup = nLookups > 0 ? Summary.Median*1e6/nLookups : 0.;
+	std::cout << std::setw(20) << "Lookups" << " : " << nLookups << " in " << Summary.Median << " ms (" << LookupsPerSecond << " /s, " << NsPerLookup << " ns each, "
+		  << nExceptions << " exceptions) [checksum " << (Sink & 0xffff) << "]" << std::endl;
+
+	BenchmarkRecord Record;
+	Record.Add("Config",ConfigNames[iConfig]);
+	Record.Add("Implementation",Oscillator->ReturnImplementationName());
+	Record.Add("CalculationType",CalculationType);
+	Record.Add("Distribution",Distributions[iDist]);
+	Record.Add("nEvents",nEvents[iEvents]);
+	Record.Add("nLookups",nLookups);
+	Record.Add("nExceptions",nExceptions);
+	Record.Add("nRepeats",nRepeats);
+	Record.Add("Lookup",Summary);
+	Record.Add("LookupsPerSecond",LookupsPerSecond);
+	Record.Add("NsPerLookup",NsPerLookup);
+	Records.push_back(Record);
+      }
+    }
+
+    delete Oscillator;
+  }
+
+  WriteBenchmarkRecords(OutputName,"lookup",Records);
+  return 0;
+}
+
+// Key which identifies a benchmark result between two runs
+std::string ReturnResultKey(const YAML::Node& Result) {
+  std::string Key = Result["Config"].as<std::string>();
+  for (std::string Field : {"Knob","KnobValue","nEnergyPoints","nCosineZPoints","Threads","VariedParameter","Scaling","Distribution","nEvents"}) {
+    if (Result[Field]) {
+      Key += " | "+Field+"="+Result[Field].as<std::string>();
+    }
+  }
+  return Key;
+}
+
+// Time which is compared between two runs: the reweight time, the total setup time for "setup" results, or the time of all lookups for "lookup" results
+double ReturnResultTime(const YAML::Node& Result) {
+  if (Result["ReweightMedian_ms"]) return Result["ReweightMedian_ms"].as<double>();
+  if (Result["LookupMedian_ms"]) return Result["LookupMedian_ms"].as<double>();
+  return Result["TotalMedian_ms"].as<double>();
+}
+
+int CompareBenchmarks(const std::string& BaselineName, const std::string& CurrentName, double Tolerance) {
+  YAML::Node Baseline = YAML::LoadFile(BaselineName);
+  YAML::Node Current = YAML::LoadFile(CurrentName);
+
+  std::unordered_map<std::string, double> BaselineMedians;
+  std::vector<std::string> BaselineKeys;
+  for (auto Result : Baseline["Results"]) {
+    std::string Key = ReturnResultKey(Result);
+    if (!BaselineMedians.count(Key)) BaselineKeys.push_back(Key);
+    BaselineMedians[Key] = ReturnResultTime(Result);
+  }
+  std::unordered_set<std::string> CurrentKeys;
+
+  int nSlowdowns = 0;
+  int nCompared = 0;
+
+  std::cout << "========================================================" << std::endl;
+  std::cout << "Comparing " << CurrentName << " to baseline " << BaselineName << " (Tolerance = " << Tolerance*100. << "%)" << std::endl;
+  for (auto Result : Current["Results"]) {
+    std::string Key = ReturnResultKey(Result);
+    CurrentKeys.insert(Key);
+    if (!BaselineMedians.count(Key)) {
+      std::cout << "  [NEW]      " << Key << std::endl;
+      continue;
+    }
+
+    double BaselineMedian = BaselineMedians[Key];
+    double CurrentMedian = ReturnResultTime(Result);
+    double Ratio = BaselineMedian > 0. ? CurrentMedian/BaselineMedian : 1.;
+    nCompared++;
+
+    std::string Status = "  [OK]       ";
+    if (Ratio > 1.+Tolerance) {
+      Status = "  [SLOWDOWN] ";
+      nSlowdowns++;
+    } else if (Ratio < 1./(1.+Tolerance)) {
+      Status = "  [SPEEDUP]  ";
+    }
+    std::cout << Status << Key << " : " << BaselineMedian << " ms -> " << CurrentMedian << " ms (x" << Ratio << ")" << std::endl;
+  }
+
+  // A baseline result which is no longer produced would otherwise hide a regression
+  int nMissing = 0;
+  for (size_t iKey=0;iKey<BaselineKeys.size();iKey++) {
+    if (CurrentKeys.count(BaselineKeys[iKey])) continue;
+    std::cout << "  [MISSING]  " << BaselineKeys[iKey] << std::endl;
+    nMissing++;
+  }
+
+  std::cout << "========================================================" << std::endl;
+  std::cout << "Compared " << nCompared << " results, found " << nSlowdowns << " slowdowns and " << nMissing << " baseline results missing from the current run" << std::endl;
+  return (nSlowdowns > 0 || nMissing > 0) ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    PrintUsage(argv[0]);
+    throw std::runtime_error("Invalid setup");
+  }
+  std::string Mode = argv[1];
+
+  if (Mode == "run") {
+    std::string OutputName = argc > 3 ? argv[3] : "";
+    return RunBenchmark(argv[2],OutputName);
+  }
+
+  if (Mode == "scaling") {
+    std::string OutputName = argc > 3 ? argv[3] : "";
+    return RunScalingBenchmark(argv[2],OutputName);
+  }
+
+  if (Mode == "setup") {
+    std::string OutputName = argc > 3 ? argv[3] : "";
+    return RunSetupBenchmark(argv[2],OutputName);
+  }
+
+  if (Mode == "pareto") {
+    std::string OutputName = argc > 3 ? argv[3] : "";
+    return RunParetoBenchmark(argv[2],OutputName);
+  }
+
+  if (Mode == "lookup") {
+    std::string OutputName = argc > 3 ? argv[3] : "";
+    return RunLookupBenchmark(argv[2],OutputName);
+  }
+
+  if (Mode == "compare") {
+    if (argc < 4) {
+      PrintUsage(argv[0]);
+      throw std::runtime_error("Invalid setup");
+    }
+    double Tolerance = argc > 4 ? atof(argv[4]) : 0.1;
+    return CompareBenchmarks(argv[2],argv[3],Tolerance);
+  }
+
+  std::cerr << "Unknown mode:" << Mode << std::endl;
+  PrintUsage(argv[0]);
+  throw std::runtime_error("Invalid setup");
+}
@@ -0,0 +1,427 @@
+#include "BenchmarkUtils.h"
+
+#include "OscProbCalcer/OscProbCalcerFactory.h"
+#include "Oscillator/OscillatorGroup.h"
+
+#include <iostream>
+#include <math.h>
+#include <chrono>
+#include <memory>
+
+using std::chrono::high_resolution_clock;
+using std::chrono::duration;
+
+void PrintUsage(char* ExecName) {
+  std::cerr << "Usage:" << std::endl;
+  std::cerr << ExecName << " ValidationConfig.yaml [Name1 Name2 ...]" << std::endl;
+  std::cerr << "    Compare the probabilities of each validation (or only those named) to its stored reference, and check the reweight time against its budget" << std::endl;
+  std::cerr << "    Each group (or only those named) is checked to give exactly the probabilities of calculating its Oscillators one by one" << std::endl;
+  std::cerr << "    Returns 1 if any validation fails" << std::endl;
+}
+
+// A single line of a stored reference
+struct StoredProbability {
+  int NuType;
+  int GeneratedFlavour;
+  int DetectedFlavour;
+  double Energy;
+  double CosineZ;
+  double Probability;
+};
+
+/*
+ * Read the probabilities from the output of SingleOscProbCalcer ("Index NuType Generated Detected Energy CosineZ Probability") or from
+ * OscProbCalcerBase::PrintWeights() as printed by SingleOscillator ("Index: 0 | NuType: 1 | OscChan: 1 -> 1 | Energy: ... | CosZ: ... | Prob: ..."). Every other
+ * line is ignored
+ */
+std::vector<StoredProbability> ReadStoredProbabilities(const std::string& FileName) {
+  std::ifstream File(FileName);
+  if (!File.is_open()) {
+    std::cerr << "Could not open stored reference:" << FileName << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+
+  std::vector<StoredProbability> Probabilities;
+  std::string Line;
+  while (std::getline(File,Line)) {
+    if (Line.rfind("Index:",0) == 0) {
+      for (std::string Label : {"Index:","NuType:","OscChan:","Energy:","CosZ:","Prob:","->","|"}) {
+	size_t Position;
+	while ((Position = Line.find(Label)) != std::string::npos) {
+	  Line.replace(Position,Label.size()," ");
+	}
+      }
+    }
+
+    std::istringstream Stream(Line);
+    long Index;
+    StoredProbability Probability;
+    if (!(Stream >> Index >> Probability.NuType >> Probability.GeneratedFlavour >> Probability.DetectedFlavour >> Probability.Energy >> Probability.CosineZ >> Probability.Probability)) continue;
+    std::string Remainder;
+    if (Stream >> Remainder) continue;
+
+    if (Index != (long)Probabilities.size()) {
+      std::cerr << "Stored reference:" << FileName << " has index " << Index << " where " << Probabilities.size() << " was expected" << std::endl;
+      throw std::runtime_error("Invalid setup");
+    }
+    Probabilities.push_back(Probability);
+  }
+
+  return Probabilities;
+}
+
+// Move every parameter by a relative Step from its nominal value (or by Step if it is zero), where Step = 0 restores the nominal values
+void ShiftParameters(std::unordered_map<std::string, FLOAT_T>& Parameters, const std::unordered_map<std::string, FLOAT_T>& Nominal, double Step) {
+  for (auto Parameter : Nominal) {
+    Parameters[Parameter.first] = (Parameter.second == 0.) ? Step : Parameter.second*(1.+Step);
+  }
+}
+
+// Either an OscProbCalcer or an Oscillator, set up the same way as SingleOscProbCalcer and SingleOscillator which produce the stored references. NThreads > 0
+// overrides the number of threads given in the config
+class ValidationTarget {
+ public:
+  ValidationTarget(const std::string& Type, const std::string& ConfigName, std::unordered_map<std::string, FLOAT_T>& OscillationParameters, int NThreads=0) {
+    std::vector<FLOAT_T> EnergyArray = logspace(0.1,100.,1e3);
+    std::vector<FLOAT_T> CosineZArray = linspace(-1.0,1.0,15);
+
+    if (Type == "OscProbCalcer") {
+      OscProbCalcerFactory* OscProbCalcFactory = new OscProbCalcerFactory();
+      Calcer = OscProbCalcFactory->CreateOscProbCalcer(ConfigName);
+      delete OscProbCalcFactory;
+
+      for (auto Parameter : OscillationParameters) {
+	Calcer->DefineParameter(Parameter.first,&OscillationParameters[Parameter.first]);
+      }
+      Calcer->SetEnergyArray(EnergyArray);
+      if (!Calcer->ReturnCosineZIgnored()) {
+	Calcer->SetCosineZArray(CosineZArray);
+      }
+      if (NThreads > 0) Calcer->SetNThreads(NThreads);
+      Calcer->Setup();
+    } else if (Type == "Oscillator") {
+      OscillatorFactory* OscFactory = new OscillatorFactory();
+      Oscillator = OscFactory->CreateOscillator(ConfigName);
+      delete OscFactory;
+
+      if (!Oscillator->EvalPointsSetInConstructor()) {
+	Oscillator->SetEnergyArrayInCalcer(EnergyArray);
+	if (!Oscillator->ReturnCosineZIgnored()) {
+	  Oscillator->SetCosineZArrayInCalcer(CosineZArray);
+	}
+      }
+      for (auto Parameter : OscillationParameters) {
+	Oscillator->DefineParameter(Parameter.first,&OscillationParameters[Parameter.first]);
+      }
+      if (NThreads > 0) Oscillator->SetNThreads(NThreads);
+      Oscillator->Setup();
+    } else {
+      std::cerr << "Unknown validation Type:" << Type << " - Expected OscProbCalcer or Oscillator" << std::endl;
+      throw std::runtime_error("Invalid setup");
+    }
+  }
+
+  ~ValidationTarget() {
+    delete Calcer;
+    delete Oscillator;
+  }
+
+  ValidationTarget(const ValidationTarget&) = delete;
+  ValidationTarget& operator=(const ValidationTarget&) = delete;
+
+  void Reweight() {
+    if (Calcer) {
+      Calcer->Reweight();
+    } else {
+      Oscillator->CalculateProbabilities();
+    }
+  }
+
+  // Only Oscillators provide OscillatorBase::CalculateProbabilitiesAsync()
+  bool SupportsAsync() {
+    return Oscillator != nullptr;
+  }
+
+  std::shared_future<void> ReweightAsync() {
+    return Oscillator->CalculateProbabilitiesAsync();
+  }
+
+  std::vector<NuOscillator::OscillationProbability> ReturnProbabilities() {
+    return Calcer ? Calcer->ReturnProbabilities() : Oscillator->ReturnProbabilities();
+  }
+
+  int ReturnNThreads() {
+    return Calcer ? Calcer->ReturnNThreads() : Oscillator->ReturnNThreads();
+  }
+
+  // Only set for Oscillators
+  OscillatorBase* ReturnOscillator() {
+    return Oscillator;
+  }
+
+  std::string ReturnImplementationName() {
+    return Calcer ? Calcer->ReturnImplementationName() : Oscillator->ReturnImplementationName();
+  }
+
+ private:
+  OscProbCalcerBase* Calcer = nullptr;
+  OscillatorBase* Oscillator = nullptr;
+};
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    PrintUsage(argv[0]);
+    throw std::runtime_error("Invalid setup");
+  }
+
+  YAML::Node Config = YAML::LoadFile(argv[1]);
+  if (!Config["Validation"] || !Config["Validation"]["Validations"]) {
+    std::cerr << "Did not find the 'Validation''Validations' Node within the config:" << argv[1] << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  YAML::Node Validation = Config["Validation"];
+
+  std::vector<std::string> RequestedNames;
+  for (int iArg=2;iArg<argc;iArg++) {
+    RequestedNames.push_back(argv[iArg]);
+  }
+
+  // Defaults which each validation can overwrite. The stored references are printed to 6 significant figures
+  double DefaultAbsoluteTolerance = Validation["AbsoluteTolerance"] ? Validation["AbsoluteTolerance"].as<double>() : 1e-5;
+  double DefaultRelativeTolerance = Validation["RelativeTolerance"] ? Validation["RelativeTolerance"].as<double>() : 0.;
+  int nWarmup = Validation["nWarmup"] ? Validation["nWarmup"].as<int>() : 2;
+  int nIterations = Validation["nIterations"] ? Validation["nIterations"].as<int>() : 20;
+  int MaxReportedFailures = Validation["MaxReportedFailures"] ? Validation["MaxReportedFailures"].as<int>() : 10;
+  std::string OutputName = Validation["Output"] ? Validation["Output"].as<std::string>() : "";
+
+  std::vector<BenchmarkRecord> Records;
+  int nValidations = 0;
+  int nFailed = 0;
+
+  for (auto Entry : Validation["Validations"]) {
+    std::string Name = Entry["Name"].as<std::string>();
+    if (RequestedNames.size() > 0 && std::find(RequestedNames.begin(),RequestedNames.end(),Name) == RequestedNames.end()) continue;
+    nValidations++;
+
+    std::string Type = Entry["Type"] ? Entry["Type"].as<std::string>() : "OscProbCalcer";
+    std::string ConfigName = Entry["Config"].as<std::string>();
+    std::string ReferenceName = Entry["Reference"].as<std::string>();
+    double AbsoluteTolerance = Entry["AbsoluteTolerance"] ? Entry["AbsoluteTolerance"].as<double>() : DefaultAbsoluteTolerance;
+    double RelativeTolerance = Entry["RelativeTolerance"] ? Entry["RelativeTolerance"].as<double>() : DefaultRelativeTolerance;
+    double TimeBudget = Entry["TimeBudget_ms"] ? Entry["TimeBudget_ms"].as<double>() : -1.;
+    double MinAbsCosineZ = Entry["MinAbsCosineZ"] ? Entry["MinAbsCosineZ"].as<double>() : 0.;
+
+    std::cout << "========================================================" << std::endl;
+    std::cout << "Validating " << Name << " (" << Type << ": " << ConfigName << ") against " << ReferenceName << std::endl;
+
+    std::vector<StoredProbability> Stored = ReadStoredProbabilities(ReferenceName);
+
+    std::unordered_map<std::string, FLOAT_T> OscillationParameters = ReturnOscParamsFromConfig(YAML::LoadFile(ConfigName));
+    std::unordered_map<std::string, FLOAT_T> NominalParameters = OscillationParameters;
+    ValidationTarget Target(Type,ConfigName,OscillationParameters);
+
+    Target.Reweight();
+    std::vector<NuOscillator::OscillationProbability> Probabilities = Target.ReturnProbabilities();
+
+    bool Passed = true;
+    long nMismatches = 0;
+    long nSkipped = 0;
+    double MaxDeviation = 0.;
+
+    if (Probabilities.size() != Stored.size()) {
+      std::cout << "  Calculated " << Probabilities.size() << " probabilities but the reference holds " << Stored.size() << std::endl;
+      Passed = false;
+    } else {
+      for (size_t iProb=0;iProb<Stored.size();iProb++) {
+	const NuOscillator::OscillationProbability& Calculated = Probabilities[iProb];
+
+	// Evaluation points are printed to 6 significant figures
+	bool SamePoint = (Calculated.NuType == Stored[iProb].NuType) && (Calculated.OscChan.GeneratedFlavour == Stored[iProb].GeneratedFlavour)
+	  && (Calculated.OscChan.DetectedFlavour == Stored[iProb].DetectedFlavour) && (fabs(Calculated.Energy-Stored[iProb].Energy) <= 1e-5*fabs(Stored[iProb].Energy))
+	  && (fabs(Calculated.CosineZ-Stored[iProb].CosineZ) <= 1e-5*std::max(1.,fabs(Stored[iProb].CosineZ)));
+
+	// References from another engine can build the path differently at the horizon, where the probabilities change fastest with the path length
+	if (SamePoint && fabs(Stored[iProb].CosineZ) < MinAbsCosineZ) {
+	  nSkipped++;
+	  continue;
+	}
+
+	double Deviation = fabs(Calculated.Probability-Stored[iProb].Probability);
+	MaxDeviation = std::max(MaxDeviation,Deviation);
+	bool WithinTolerance = (Deviation <= AbsoluteTolerance+RelativeTolerance*fabs(Stored[iProb].Probability));
+
+	if (!SamePoint || !WithinTolerance) {
+	  if (nMismatches < MaxReportedFailures) {
+	    std::cout << "  Index " << iProb << (SamePoint ? "" : " (different evaluation point)") << " : NuType " << Calculated.NuType << ", "
+		      << Calculated.OscChan.GeneratedFlavour << " -> " << Calculated.OscChan.DetectedFlavour << ", Energy " << Calculated.Energy << ", CosZ " << Calculated.CosineZ
+		      << " : " << std::setprecision(10) << Calculated.Probability << " vs stored " << Stored[iProb].Probability << std::setprecision(6) << std::endl;
+	  }
+	  nMismatches++;
+	  Passed = false;
+	}
+      }
+    }
+    std::cout << "  " << nMismatches << " of " << Stored.size() << " probabilities outside |dP| <= " << AbsoluteTolerance << " + " << RelativeTolerance << "*P (max |dP| = " << MaxDeviation << ")" << std::endl;
+    if (nSkipped > 0) std::cout << "  " << nSkipped << " probabilities with |cos(zenith)| < " << MinAbsCosineZ << " not compared" << std::endl;
+
+    // Splitting the calculation across threads must give exactly the single threaded result, which catches engines sharing state between threads
+    long nThreadMismatches = -1;
+    if (Target.ReturnNThreads() > 1) {
+      ValidationTarget SingleThreadTarget(Type,ConfigName,OscillationParameters,1);
+      SingleThreadTarget.Reweight();
+      std::vector<NuOscillator::OscillationProbability> SingleThreadProbabilities = SingleThreadTarget.ReturnProbabilities();
+
+      nThreadMismatches = 0;
+      for (size_t iProb=0;iProb<Probabilities.size();iProb++) {
+	if (Probabilities[iProb].Probability != SingleThreadProbabilities[iProb].Probability) nThreadMismatches++;
+      }
+      std::cout << "  " << nThreadMismatches << " of " << Probabilities.size() << " probabilities differ between " << Target.ReturnNThreads() << " threads and a single thread" << std::endl;
+      if (nThreadMismatches > 0) Passed = false;
+    }
+
+    // The asynchronous calculation must give exactly the synchronous result, even if the parameters are changed back as soon as it has started
+    long nAsyncMismatches = -1;
+    if (Target.SupportsAsync()) {
+      ShiftParameters(OscillationParameters,NominalParameters,1e-3);
+      Target.Reweight();
+      std::vector<NuOscillator::OscillationProbability> SyncProbabilities = Target.ReturnProbabilities();
+
+      ShiftParameters(OscillationParameters,NominalParameters,0.);
+      Target.Reweight();
+
+      ShiftParameters(OscillationParameters,NominalParameters,1e-3);
+      std::shared_future<void> Calculation = Target.ReweightAsync();
+      ShiftParameters(OscillationParameters,NominalParameters,0.);
+      Calculation.get();
+      std::vector<NuOscillator::OscillationProbability> AsyncProbabilities = Target.ReturnProbabilities();
+
+      nAsyncMismatches = 0;
+      for (size_t iProb=0;iProb<SyncProbabilities.size();iProb++) {
+	if (AsyncProbabilities[iProb].Probability != SyncProbabilities[iProb].Probability) nAsyncMismatches++;
+      }
+      std::cout << "  " << nAsyncMismatches << " of " << SyncProbabilities.size() << " probabilities differ between CalculateProbabilitiesAsync() and CalculateProbabilities()" << std::endl;
+      if (nAsyncMismatches > 0) Passed = false;
+    }
+
+    // Alternate every parameter between two clearly different values, such that each timed reweight does the full calculation. A relative step of 1e-3 is
+    // resolved in single precision and, as it also moves the non delta_cp parameters, can not be served by the delta_cp harmonic cache
+    std::vector<double> Times(nIterations);
+    for (int iIteration=-nWarmup;iIteration<nIterations;iIteration++) {
+      ShiftParameters(OscillationParameters,NominalParameters,((iIteration+nWarmup)%2 == 0) ? 1e-3 : -1e-3);
+      auto t1 = high_resolution_clock::now();
+      Target.Reweight();
+      auto t2 = high_resolution_clock::now();
+      duration<double, std::milli> ms_double = t2-t1;
+      if (iIteration >= 0) Times[iIteration] = ms_double.count();
+    }
+    TimingSummary Summary = SummariseTimes(Times);
+
+    bool WithinBudget = (TimeBudget < 0. || Summary.Median <= TimeBudget);
+    std::cout << "  Median reweight " << Summary.Median << " ms";
+    if (TimeBudget >= 0.) std::cout << " (budget " << TimeBudget << " ms)";
+    std::cout << std::endl;
+    Passed = Passed && WithinBudget;
+
+    std::cout << (Passed ? "  [PASS] " : "  [FAIL] ") << Name << std::endl;
+    if (!Passed) nFailed++;
+
+    BenchmarkRecord Record;
+    Record.Add("Name",Name);
+    Record.Add("Config",ConfigName);
+    Record.Add("Implementation",Target.ReturnImplementationName());
+    Record.Add("Reference",ReferenceName);
+    Record.Add("nProbabilities",(long)Stored.size());
+    Record.Add("nMismatches",nMismatches);
+    Record.Add("MaxDeviation",MaxDeviation);
+    Record.Add("nSkipped",nSkipped);
+    Record.Add("nThreadMismatches",nThreadMismatches);
+    Record.Add("nAsyncMismatches",nAsyncMismatches);
+    Record.Add("Reweight",Summary);
+    Record.Add("TimeBudget_ms",TimeBudget);
+    Record.Add("Passed",(long)Passed);
+    Records.push_back(Record);
+  }
+
+  // Each group calculates its Oscillators together through OscillatorGroup, which must give exactly the probabilities of calculating each of them on its own, both
+  // before and after the group has measured the cost of each Oscillator
+  for (auto Entry : Validation["Groups"]) {
+    std::string Name = Entry["Name"].as<std::string>();
+    if (RequestedNames.size() > 0 && std::find(RequestedNames.begin(),RequestedNames.end(),Name) == RequestedNames.end()) continue;
+    nValidations++;
+
+    std::vector<std::string> ConfigNames = Entry["Configs"].as< std::vector<std::string> >();
+    int nOscillators = (int)ConfigNames.size();
+
+    std::cout << "========================================================" << std::endl;
+    std::cout << "Validating group " << Name << " of " << nOscillators << " Oscillators against calculating them one by one" << std::endl;
+
+    // Both copies of each Oscillator read the same parameters, which are sized up front so the pointers given to DefineParameter() stay valid
+    std::vector< std::unordered_map<std::string, FLOAT_T> > OscillationParameters(nOscillators);
+    std::vector< std::unordered_map<std::string, FLOAT_T> > NominalParameters(nOscillators);
+    std::vector< std::unique_ptr<ValidationTarget> > GroupTargets;
+    std::vector< std::unique_ptr<ValidationTarget> > IndividualTargets;
+
+    OscillatorGroup Group;
+    // Builds without multithreading always run the group on a single thread
+#if UseMultithreading == 1
+    if (Entry["Threads"]) Group.SetNThreads(Entry["Threads"].as<int>());
+#endif
+    for (int iOscillator=0;iOscillator<nOscillators;iOscillator++) {
+      OscillationParameters[iOscillator] = ReturnOscParamsFromConfig(YAML::LoadFile(ConfigNames[iOscillator]));
+      NominalParameters[iOscillator] = OscillationParameters[iOscillator];
+      GroupTargets.emplace_back(new ValidationTarget("Oscillator",ConfigNames[iOscillator],OscillationParameters[iOscillator]));
+      IndividualTargets.emplace_back(new ValidationTarget("Oscillator",ConfigNames[iOscillator],OscillationParameters[iOscillator]));
+      Group.AddOscillator(GroupTargets[iOscillator]->ReturnOscillator());
+    }
+
+    bool Passed = true;
+    long nGroupMismatches = 0;
+    long nProbabilities = 0;
+    for (double Step : {1e-3,-1e-3,0.}) {
+      for (int iOscillator=0;iOscillator<nOscillators;iOscillator++) {
+	ShiftParameters(OscillationParameters[iOscillator],NominalParameters[iOscillator],Step);
+      }
+      Group.CalculateProbabilities();
+
+      std::pair<int,int> ThreadSplit = Group.ReturnLastThreadSplit();
+      std::cout << "  Relative step " << Step << ": team phase on " << ThreadSplit.first << " threads, task phase on " << ThreadSplit.second << " threads" << std::endl;
+
+      for (int iOscillator=0;iOscillator<nOscillators;iOscillator++) {
+	IndividualTargets[iOscillator]->Reweight();
+	std::vector<NuOscillator::OscillationProbability> GroupProbabilities = GroupTargets[iOscillator]->ReturnProbabilities();
+	std::vector<NuOscillator::OscillationProbability> IndividualProbabilities = IndividualTargets[iOscillator]->ReturnProbabilities();
+
+	long nMismatches = 0;
+	for (size_t iProb=0;iProb<IndividualProbabilities.size();iProb++) {
+	  if (GroupProbabilities[iProb].Probability != IndividualProbabilities[iProb].Probability) nMismatches++;
+	}
+	std::cout << "    " << ConfigNames[iOscillator] << " (" << (Group.ReturnLastRunOnTeam()[iOscillator] ? "team" : "task") << "): " << nMismatches << " of "
+		  << IndividualProbabilities.size() << " probabilities differ" << std::endl;
+	nGroupMismatches += nMismatches;
+	nProbabilities += (long)IndividualProbabilities.size();
+      }
+    }
+    if (nGroupMismatches > 0) Passed = false;
+
+    std::cout << (Passed ? "  [PASS] " : "  [FAIL] ") << Name << std::endl;
+    if (!Passed) nFailed++;
+
+    BenchmarkRecord Record;
+    Record.Add("Name",Name);
+    Record.Add("nOscillators",nOscillators);
+    Record.Add("nThreads",Group.ReturnNThreads());
+    Record.Add("nProbabilities",nProbabilities);
+    Record.Add("nGroupMismatches",nGroupMismatches);
+    Record.Add("Passed",(long)Passed);
+    Records.push_back(Record);
+  }
+
+  std::cout << "========================================================" << std::endl;
+  std::cout << nValidations-nFailed << " of " << nValidations << " validations passed" << std::endl;
+
+  if (OutputName != "") {
+    WriteBenchmarkRecords(OutputName,"validation",Records);
+  }
+
+  return nFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,141 @@
+#include "BenchmarkUtils.h"
+
+#include "Constants/OscillatorConstants.h"
+#include "OscProbCalcer/OscProbCalcerBase.h"
+
+#include "OscProbCalcer/OscProbCalcerFactory.h"
+
+#include <iostream>
+#include <iomanip>
+#include <math.h>
+#include <chrono>
+
+using std::chrono::high_resolution_clock;
+using std::chrono::duration;
+
+// Build and setup a NuSQUIDSLinear calcer from Config with the requested stepper and integration precision
+OscProbCalcerBase* CreateCalcer(YAML::Node Config, const std::string& Stepper, std::unordered_map<std::string, FLOAT_T>& OscillationParameters,
+				const std::vector<FLOAT_T>& EnergyArray, double RelativeError=-1, double AbsoluteError=-1) {
+  Config["OscProbCalcerSetup"]["Stepper"] = Stepper;
+  if (RelativeError > 0) {Config["OscProbCalcerSetup"]["RelativeError"] = RelativeError;}
+  if (AbsoluteError > 0) {Config["OscProbCalcerSetup"]["AbsoluteError"] = AbsoluteError;}
+
+  OscProbCalcerFactory* OscProbCalcFactory = new OscProbCalcerFactory();
+  OscProbCalcerBase* Calcer = OscProbCalcFactory->CreateOscProbCalcer(Config);
+  delete OscProbCalcFactory;
+
+  for (auto Parameter : OscillationParameters) {
+    Calcer->DefineParameter(Parameter.first,&OscillationParameters[Parameter.first]);
+  }
+  Calcer->SetEnergyArray(EnergyArray);
+  Calcer->Setup();
+
+  return Calcer;
+}
+
+std::vector<FLOAT_T> ReturnProbabilityValues(OscProbCalcerBase* Calcer) {
+  std::vector<NuOscillator::OscillationProbability> OscProbs = Calcer->ReturnProbabilities();
+  std::vector<FLOAT_T> Values(OscProbs.size());
+  for (size_t iOscProb=0;iOscProb<OscProbs.size();iOscProb++) {
+    Values[iOscProb] = OscProbs[iOscProb].Probability;
+  }
+  return Values;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << argv[0] << " nIterations NuSQUIDSLinearConfig.yaml [Stepper1 Stepper2 ...]" << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  int nThrows = atoi(argv[1]);
+  std::string OscProbCalcerConfigname = argv[2];
+
+  std::vector<std::string> Steppers;
+  if (argc == 3) {
+    Steppers = {"rk2","rk4","rkf45","rkck","rk8pd"};
+  } else {
+    for (int i=3;i<argc;i++) {
+      Steppers.push_back(argv[i]);
+    }
+  }
+
+  YAML::Node Config = YAML::LoadFile(OscProbCalcerConfigname);
+  std::unordered_map<std::string, FLOAT_T> OscillationParameters = ReturnOscParamsFromConfig(Config);
+
+  std::vector<FLOAT_T> EnergyArray = logspace(0.1,100.,1e3);
+
+  // Use the same set of delta_cp throws for every stepper, from a fixed seed such that runs can be compared
+  const unsigned int Seed = 1234;
+  std::unordered_map<std::string, FLOAT_T> ThrownParameters = OscillationParameters;
+  OscillationParameterThrower Thrower(OscillationParameters,"delta_cp",Seed);
+  if (!Thrower.IsValid()) {
+    std::cerr << "delta_cp is not an oscillation parameter of config:" << OscProbCalcerConfigname << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  std::vector<FLOAT_T> DeltaCPThrows(nThrows);
+  for (int iThrow=0;iThrow<nThrows;iThrow++) {
+    Thrower.Throw(ThrownParameters);
+    DeltaCPThrows[iThrow] = ThrownParameters["delta_cp"];
+  }
+
+  std::cout << "========================================================" << std::endl;
+  std::cout << "Calculating reference probabilities with rk8pd at tight precision" << std::endl;
+
+  // Reference calculation which every stepper is compared to
+  OscProbCalcerBase* ReferenceCalcer = CreateCalcer(YAML::Clone(Config),"rk8pd",OscillationParameters,EnergyArray,1.0e-12,1.0e-12);
+  std::vector< std::vector<FLOAT_T> > ReferenceProbabilities(nThrows);
+  for (int iThrow=0;iThrow<nThrows;iThrow++) {
+    OscillationParameters["delta_cp"] = DeltaCPThrows[iThrow];
+    ReferenceCalcer->Reweight();
+    ReferenceProbabilities[iThrow] = ReturnProbabilityValues(ReferenceCalcer);
+  }
+  delete ReferenceCalcer;
+
+  std::vector<double> MeanTimes(Steppers.size());
+  std::vector<double> MaxDifferences(Steppers.size());
+  std::vector<double> RMSDifferences(Steppers.size());
+
+  for (size_t iStepper=0;iStepper<Steppers.size();iStepper++) {
+    std::cout << "========================================================" << std::endl;
+    std::cout << "Benchmarking stepper:" << Steppers[iStepper] << std::endl;
+
+    OscProbCalcerBase* Calcer = CreateCalcer(YAML::Clone(Config),Steppers[iStepper],OscillationParameters,EnergyArray);
+
+    double TotalTime = 0.;
+    double MaxDifference = 0.;
+    double SumSquaredDifference = 0.;
+    long nProbabilities = 0;
+
+    for (int iThrow=0;iThrow<nThrows;iThrow++) {
+      OscillationParameters["delta_cp"] = DeltaCPThrows[iThrow];
+
+      auto t1 = high_resolution_clock::now();
+      Calcer->Reweight();
+      auto t2 = high_resolution_clock::now();
+      duration<double, std::milli> ms_double = t2-t1;
+      TotalTime += ms_double.count();
+
+      std::vector<FLOAT_T> Probabilities = ReturnProbabilityValues(Calcer);
+      for (size_t iProb=0;iProb<Probabilities.size();iProb++) {
+	double Difference = fabs(Probabilities[iProb]-ReferenceProbabilities[iThrow][iProb]);
+	MaxDifference = std::max(MaxDifference,Difference);
+	SumSquaredDifference += Difference*Difference;
+	nProbabilities++;
+      }
+    }
+
+    MeanTimes[iStepper] = TotalTime/nThrows;
+    MaxDifferences[iStepper] = MaxDifference;
+    RMSDifferences[iStepper] = sqrt(SumSquaredDifference/std::max(nProbabilities,1L));
+
+    delete Calcer;
+  }
+
+  std::cout << "========================================================" << std::endl;
+  std::cout << "Config:" << OscProbCalcerConfigname << " | nIterations:" << nThrows << " | Seed:" << Seed << " | Reference: rk8pd (RelativeError=AbsoluteError=1e-12)" << std::endl;
+  std::cout << std::setw(10) << "Stepper" << std::setw(20) << "Mean time [ms]" << std::setw(20) << "Max |dP|" << std::setw(20) << "RMS dP" << std::endl;
+  for (size_t iStepper=0;iStepper<Steppers.size();iStepper++) {
+    std::cout << std::setw(10) << Steppers[iStepper] << std::setw(20) << MeanTimes[iStepper] << std::setw(20) << MaxDifferences[iStepper] << std::setw(20) << RMSDifferences[iStepper] << std::endl;
+  }
+  std::cout << "========================================================" << std::endl;
+}
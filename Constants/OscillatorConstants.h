@@ -72,6 +72,10 @@ namespace NuOscillator
 inline std::vector<std::string> ReturnKnownConfigs() {
   std::vector<std::string> ConfigNames;
 
+#if UseNativeLinear == 1
+  ConfigNames.push_back("./NuOscillatorConfigs/Binned_NativeLinear.yaml");
+#endif
+
 #if UseCUDAProb3 == 1
   ConfigNames.push_back("./NuOscillatorConfigs/Binned_CUDAProb3.yaml");
 #endif
@@ -92,6 +96,10 @@ inline std::vector<std::string> ReturnKnownConfigs() {
   ConfigNames.push_back("./NuOscillatorConfigs/Binned_NuFASTLinear.yaml");
 #endif
 
+#if UseNativeEarth == 1
+  ConfigNames.push_back("./NuOscillatorConfigs/Binned_NativeEarth.yaml");
+#endif
+
 #if UseNuFASTEarth == 1
   ConfigNames.push_back("./NuOscillatorConfigs/Binned_NuFASTEarth.yaml");
 #endif
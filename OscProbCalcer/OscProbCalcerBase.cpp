@@ -5,6 +5,17 @@
 
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <limits>
+
+#if UseMultithreading == 1
+#include "omp.h"
+#endif
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
 
 OscProbCalcerBase::OscProbCalcerBase(YAML::Node InputConfig_) {
   // Set default values of all variables within this base object
@@ -30,6 +41,8 @@ OscProbCalcerBase::OscProbCalcerBase(YAML::Node InputConfig_) {
   fOscParams = std::vector<FLOAT_T*>();
 
   fCosineZIgnored = false;
+  fSanitisedInCalcer = false;
+  fConcurrentReweightSafe = true;
 
   fEnergyArraySet = false;
   fCosineZArraySet = false;
@@ -93,9 +106,35 @@ OscProbCalcerBase::OscProbCalcerBase(YAML::Node InputConfig_) {
     }
   }
 
+  fDeltaCPCacheRequested = false;
+  fDeltaCPIndex = -1;
+  fDeltaCPHarmonicOrder = 0;
+  fDeltaCPHarmonicsValid = false;
+  if (Config["OscProbCalcerSetup"]["DeltaCPCache"]) {
+    fDeltaCPCacheRequested = Config["OscProbCalcerSetup"]["DeltaCPCache"].as<bool>();
+  }
+
+  fNThreads = 1;
+#if UseMultithreading == 1
+  fNThreads = omp_get_max_threads();
+#endif
+  fNThreadsFixedAtSetup = false;
+  fSingleThreadOnly = false;
+  if (Config["OscProbCalcerSetup"]["Threads"]) {
+    SetNThreads(Config["OscProbCalcerSetup"]["Threads"].as<int>());
+  }
+
+  fCPUSet = std::vector<int>();
+#ifdef __linux__
+  fBindingThreadID = 0;
+#endif
+  if (Config["OscProbCalcerSetup"]["CPUSet"]) {
+    SetCPUSet(Config["OscProbCalcerSetup"]["CPUSet"].as< std::vector<int> >());
+  }
 }
 
 OscProbCalcerBase::~OscProbCalcerBase() {
+  RestoreThreadAffinities();
 }
 
 void OscProbCalcerBase::SetEnergyArray(std::vector<FLOAT_T> EnergyArray) {
@@ -207,9 +246,28 @@ void OscProbCalcerBase::Setup() {
   SetupPropagator();
   fPropagatorSet = true;
 
+  if (fCPUSet.size() > 0) {BindThreads();}
+
   CheckOscillationParametersDefined();
   CheckNuFlavourMapping();
 
+  if (fDeltaCPCacheRequested) {
+    if (fDeltaCPIndex < 0 || fDeltaCPIndex >= fNOscParams) {
+      std::cerr << "DeltaCPCache requested but implementation:" << fImplementationName << " does not support the delta_cp harmonic cache" << std::endl;
+      throw std::runtime_error("Invalid setup");
+    }
+    // Channels which do not involve an electron (anti)neutrino pick up cos(2 delta_cp) and sin(2 delta_cp) terms
+    fDeltaCPHarmonicOrder = 1;
+    for (int iOscChannel=0;iOscChannel<fNOscillationChannels;iOscChannel++) {
+      if (fOscillationChannels[iOscChannel].GeneratedFlavour != NuOscillator::kElectron && fOscillationChannels[iOscChannel].DetectedFlavour != NuOscillator::kElectron) {
+	fDeltaCPHarmonicOrder = 2;
+      }
+    }
+    fDeltaCPHarmonics = std::vector< std::vector<FLOAT_T> >(2*fDeltaCPHarmonicOrder+1,std::vector<FLOAT_T>(fNWeights,0.));
+    fDeltaCPHarmonicsValid = false;
+    if (fVerbose >= NuOscillator::INFO) {std::cout << "Using delta_cp harmonic cache (order " << fDeltaCPHarmonicOrder << ") in implementation:" << fImplementationName << std::endl;}
+  }
+
   SanityCheck();
 }
 
@@ -347,11 +405,166 @@ void OscProbCalcerBase::Reweight() {
   if (!AreOscParamsChanged()) {
     return;
   }
-  SetCurrOscParams();
 
-  CalculateProbabilities();
-  if (!fNoSanity) {SanitiseProbabilities();}
-  if (fVerbose >= NuOscillator::INFO) {std::cout << "Implementation:" << fImplementationName << " completed reweight and was found to have sensible oscillation weights" << std::endl;}
+  if (!AreThreadsBound()) {BindThreads();}
+  ThreadSettingsGuard ThreadSettings(fNThreads);
+
+  if (fDeltaCPCacheRequested) {
+    if (!fDeltaCPHarmonicsValid || !IsOnlyDeltaCPChanged()) {
+      CalculateDeltaCPHarmonics();
+    }
+    SetCurrOscParams();
+
+    FillFromDeltaCPHarmonics(*fOscParams[fDeltaCPIndex]);
+    // Same PrecisionLimit as the uncached path, so enabling the cache does not change which probabilities are rejected
+    if (!fNoSanity) {ClampProbabilities(fWeightArray.data(),fNWeights);}
+    if (fVerbose >= NuOscillator::INFO) {std::cout << "Implementation:" << fImplementationName << " completed reweight from the delta_cp harmonic cache" << std::endl;}
+  } else {
+    SetCurrOscParams();
+
+    CalculateProbabilities();
+    if (!fNoSanity && !fSanitisedInCalcer) {SanitiseProbabilities();}
+    if (fVerbose >= NuOscillator::INFO) {std::cout << "Implementation:" << fImplementationName << " completed reweight and was found to have sensible oscillation weights" << std::endl;}
+  }
+}
+
+void OscProbCalcerBase::SetNThreads(int NThreads) {
+  if (NThreads < 1) {
+    std::cerr << "Invalid number of threads requested in implementation:" << fImplementationName << " - " << NThreads << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+#if UseMultithreading != 1
+  if (NThreads != 1) {
+    std::cerr << "Requested " << NThreads << " threads in implementation:" << fImplementationName << " but NuOscillator was built without multithreading" << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+#endif
+  if (fSingleThreadOnly && NThreads != 1) {
+    std::cerr << "Implementation:" << fImplementationName << " only supports a single thread, but " << NThreads << " were requested" << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  if (fPropagatorSet && fNThreadsFixedAtSetup && NThreads != fNThreads) {
+    std::cerr << "Implementation:" << fImplementationName << " sizes its per-thread resources in SetupPropagator(), so the number of threads can not be changed after Setup()" << std::endl;
+    std::cerr << "Requested:" << NThreads << ", used:" << fNThreads << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  bool Changed = (NThreads != fNThreads);
+  fNThreads = NThreads;
+
+  // Implementations append the thread count to the name once SetupPropagator() has been called
+  size_t SuffixPosition = fImplementationName.rfind("-CPU-");
+  if (SuffixPosition != std::string::npos) {
+    fImplementationName = fImplementationName.substr(0,SuffixPosition)+"-CPU-"+std::to_string(fNThreads);
+  }
+
+  if (fVerbose >= NuOscillator::INFO) {std::cout << "Using " << fNThreads << " threads in implementation:" << fImplementationName << std::endl;}
+
+  // Before Setup() the team is bound by Setup() itself
+  if (Changed && fPropagatorSet && fCPUSet.size() > 0) {BindThreads();}
+}
+
+void OscProbCalcerBase::SetSingleThreadOnly() {
+  // The base constructor has already applied the config, before the implementation could declare this
+  if (Config["OscProbCalcerSetup"]["Threads"] && Config["OscProbCalcerSetup"]["Threads"].as<int>() != 1) {
+    std::cerr << "Implementation:" << fImplementationName << " only supports a single thread, but 'OscProbCalcerSetup''Threads' requested " << Config["OscProbCalcerSetup"]["Threads"].as<int>() << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  fSingleThreadOnly = true;
+  SetNThreads(1);
+}
+
+void OscProbCalcerBase::SetCPUSet(const std::vector<int>& CPUSet) {
+#ifdef __linux__
+  for (size_t iCPU=0;iCPU<CPUSet.size();iCPU++) {
+    if (CPUSet[iCPU] < 0 || CPUSet[iCPU] >= CPU_SETSIZE) {
+      std::cerr << "Invalid CPU index:" << CPUSet[iCPU] << " requested in implementation:" << fImplementationName << std::endl;
+      throw std::runtime_error("Invalid setup");
+    }
+  }
+  fCPUSet = CPUSet;
+
+  // Before Setup() the team is bound by Setup() itself, afterwards binding an empty set only restores the previous affinities
+  if (fPropagatorSet) {BindThreads();}
+#else
+  if (CPUSet.size() > 0) {
+    std::cerr << "Binding threads to a CPU set is only supported on Linux, requested in implementation:" << fImplementationName << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+#endif
+}
+
+void OscProbCalcerBase::BindThreads() {
+  RestoreThreadAffinities();
+
+#if UseMultithreading == 1 && defined(__linux__)
+  if (fCPUSet.size() == 0) return;
+
+  cpu_set_t Affinity;
+  CPU_ZERO(&Affinity);
+  for (size_t iCPU=0;iCPU<fCPUSet.size();iCPU++) {
+    CPU_SET(fCPUSet[iCPU],&Affinity);
+  }
+
+  // Each thread of the team saves its own affinity and ID before it is bound, so the previous affinities can be restored from any thread
+  fBoundThreadIDs = std::vector<pid_t>(fNThreads,0);
+  fPreviousAffinities = std::vector<cpu_set_t>(fNThreads);
+  fAffinitySaved = std::vector<char>(fNThreads,0);
+  fBindingThreadID = (pid_t)syscall(SYS_gettid);
+
+  bool BindFailed = false;
+  #pragma omp parallel num_threads(fNThreads) reduction(||:BindFailed)
+  {
+    int iThread = omp_get_thread_num();
+    if (sched_getaffinity(0,sizeof(cpu_set_t),&fPreviousAffinities[iThread]) == 0) {
+      fBoundThreadIDs[iThread] = (pid_t)syscall(SYS_gettid);
+      fAffinitySaved[iThread] = 1;
+      if (sched_setaffinity(0,sizeof(Affinity),&Affinity) != 0) BindFailed = true;
+    }
+  }
+  if (BindFailed) {
+    std::cerr << "WARNING - Could not bind threads to the requested CPU set in implementation:" << fImplementationName << std::endl;
+  }
+#endif
+}
+
+void OscProbCalcerBase::RestoreThreadAffinities() {
+#ifdef __linux__
+  for (size_t iThread=0;iThread<fAffinitySaved.size();iThread++) {
+    // Fails harmlessly if the thread has exited since, e.g. the team of a finished CalculateProbabilitiesAsync() call
+    if (fAffinitySaved[iThread]) {
+      sched_setaffinity(fBoundThreadIDs[iThread],sizeof(cpu_set_t),&fPreviousAffinities[iThread]);
+    }
+  }
+  fBoundThreadIDs.clear();
+  fPreviousAffinities.clear();
+  fAffinitySaved.clear();
+  fBindingThreadID = 0;
+#endif
+}
+
+bool OscProbCalcerBase::AreThreadsBound() {
+#if UseMultithreading == 1 && defined(__linux__)
+  return (fCPUSet.size() == 0 || fBindingThreadID == (pid_t)syscall(SYS_gettid));
+#else
+  return true;
+#endif
+}
+
+OscProbCalcerBase::ThreadSettingsGuard::ThreadSettingsGuard(int NThreads) {
+  fPreviousNThreads = 1;
+
+#if UseMultithreading == 1
+  fPreviousNThreads = omp_get_max_threads();
+  omp_set_num_threads(NThreads);
+#else
+  (void)NThreads;
+#endif
+}
+
+OscProbCalcerBase::ThreadSettingsGuard::~ThreadSettingsGuard() {
+#if UseMultithreading == 1
+  omp_set_num_threads(fPreviousNThreads);
+#endif
 }
 
 void OscProbCalcerBase::Reweight(const std::vector<FLOAT_T>& OscParams_) {
@@ -411,6 +624,38 @@ void OscProbCalcerBase::DefineParameter(const std::string& ParName_, FLOAT_T* Pa
   throw std::runtime_error("Invalid oscillation parameter: "+ParName_);
 }
 
+std::vector<FLOAT_T> OscProbCalcerBase::ReturnOscParamsSnapshot() {
+  std::vector<FLOAT_T> OscParamsSnapshot(fNOscParams);
+  for (int iOscPar=0;iOscPar<fNOscParams;iOscPar++) {
+    OscParamsSnapshot[iOscPar] = GetOscillationParameter(iOscPar);
+  }
+  return OscParamsSnapshot;
+}
+
+void OscProbCalcerBase::ReweightFromSnapshot(std::vector<FLOAT_T> OscParamsSnapshot) {
+  if ((int)OscParamsSnapshot.size() != fNOscParams) {
+    std::cerr << "Number of oscillation parameters in snapshot does not match that expected by the implementation" << std::endl;
+    std::cerr << "OscParamsSnapshot.size():" << OscParamsSnapshot.size() << std::endl;
+    std::cerr << "fNOscParams:" << fNOscParams << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+
+  // Point every parameter at the snapshot for the calculation, restoring the user's pointers afterwards
+  std::vector<FLOAT_T*> UserOscParams = fOscParams;
+  for (int iOscPar=0;iOscPar<fNOscParams;iOscPar++) {
+    fOscParams[iOscPar] = &OscParamsSnapshot[iOscPar];
+  }
+
+  try {
+    Reweight();
+  } catch (...) {
+    fOscParams = UserOscParams;
+    throw;
+  }
+
+  fOscParams = UserOscParams;
+}
+
 FLOAT_T OscProbCalcerBase::GetOscillationParameter(int Index) {
   // Check if the requested index is appropriate value
   if (!(Index >= 0 && Index < fNOscParams)) {
@@ -483,6 +728,31 @@ void OscProbCalcerBase::SanitiseProbabilities() {
   
 }
 
+void OscProbCalcerBase::ClampProbabilities(FLOAT_T* Probs, long nProbs, bool ClampAllButNan) {
+  // Infinite limits let every value other than nan through to the clamp
+  const FLOAT_T lower_limit = ClampAllButNan ? -std::numeric_limits<FLOAT_T>::infinity() : -1.0*PrecisionLimit;
+  const FLOAT_T upper_limit = ClampAllButNan ? std::numeric_limits<FLOAT_T>::infinity() : 1.0 + PrecisionLimit;
+  bool FoundInvalid = false;
+
+#if UseMultithreading == 1
+#pragma omp simd reduction(|:FoundInvalid)
+#endif
+  for (long iProb=0;iProb<nProbs;++iProb) {
+    const FLOAT_T Prob = Probs[iProb];
+    // Written such that nan also fails the comparison
+    const bool IsInvalid = !((Prob >= lower_limit) && (Prob <= upper_limit));
+    FLOAT_T Clamped = Prob > FLOAT_T(0.0) ? Prob : FLOAT_T(0.0);
+    Clamped = Clamped < FLOAT_T(1.0) ? Clamped : FLOAT_T(1.0);
+    Probs[iProb] = IsInvalid ? Prob : Clamped;
+    FoundInvalid |= IsInvalid;
+  }
+
+  // The invalid values were left untouched, so SanitiseProbabilities() finds and reports them
+  if (FoundInvalid && !fNoSanity) {
+    SanitiseProbabilities();
+  }
+}
+
 bool OscProbCalcerBase::AreOscParamsChanged() {
   for (int iParam=0;iParam<fNOscParams;++iParam) {
     if (*fOscParams[iParam] != fOscParamsCurr[iParam]) {
@@ -494,6 +764,108 @@ bool OscProbCalcerBase::AreOscParamsChanged() {
   return false;
 }
 
+long OscProbCalcerBase::ReturnWeightArrayBytes() {
+  long Bytes = fWeightArray.capacity()*sizeof(FLOAT_T);
+  for (size_t iHarmonic=0;iHarmonic<fDeltaCPHarmonics.size();iHarmonic++) {
+    Bytes += fDeltaCPHarmonics[iHarmonic].capacity()*sizeof(FLOAT_T);
+  }
+  return Bytes;
+}
+
+long OscProbCalcerBase::ReturnLookupTableBytes() {
+  return (fEnergyArray.capacity()+fCosineZArray.capacity())*sizeof(FLOAT_T);
+}
+
+void OscProbCalcerBase::EnableDeltaCPCache(int DeltaCPIndex) {
+  fDeltaCPIndex = DeltaCPIndex;
+}
+
+bool OscProbCalcerBase::IsOnlyDeltaCPChanged() {
+  for (int iParam=0;iParam<fNOscParams;++iParam) {
+    if (iParam == fDeltaCPIndex) continue;
+    if (*fOscParams[iParam] != fOscParamsCurr[iParam]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void OscProbCalcerBase::CalculateDeltaCPHarmonics() {
+  if (fVerbose >= NuOscillator::INFO) {std::cout << "Implementation:" << fImplementationName << " recalculating delta_cp harmonics" << std::endl;}
+
+  for (size_t iHarmonic=0;iHarmonic<fDeltaCPHarmonics.size();iHarmonic++) {
+    std::fill(fDeltaCPHarmonics[iHarmonic].begin(),fDeltaCPHarmonics[iHarmonic].end(),0.);
+  }
+
+  // Point the delta_cp parameter at a local value for the sampled evaluations, restoring the user's pointer afterwards
+  FLOAT_T* UserDeltaCP = fOscParams[fDeltaCPIndex];
+  FLOAT_T SampledDeltaCP;
+  fOscParams[fDeltaCPIndex] = &SampledDeltaCP;
+
+  // A trigonometric polynomial of order N is recovered exactly by a discrete Fourier transform of 2N+1 equally spaced samples
+  const int nSamples = 2*fDeltaCPHarmonicOrder+1;
+  try {
+    for (int iSample=0;iSample<nSamples;iSample++) {
+      SampledDeltaCP = 2.*M_PI*iSample/nSamples;
+      CalculateProbabilities();
+
+      FLOAT_T* Constant = fDeltaCPHarmonics[0].data();
+      const FLOAT_T* Weights = fWeightArray.data();
+      for (int iWeight=0;iWeight<fNWeights;iWeight++) {
+	Constant[iWeight] += Weights[iWeight]/nSamples;
+      }
+
+      for (int iOrder=1;iOrder<=fDeltaCPHarmonicOrder;iOrder++) {
+	const FLOAT_T CosWeight = 2.*cos(iOrder*SampledDeltaCP)/nSamples;
+	const FLOAT_T SinWeight = 2.*sin(iOrder*SampledDeltaCP)/nSamples;
+	FLOAT_T* CosCoeff = fDeltaCPHarmonics[2*iOrder-1].data();
+	FLOAT_T* SinCoeff = fDeltaCPHarmonics[2*iOrder].data();
+	for (int iWeight=0;iWeight<fNWeights;iWeight++) {
+	  CosCoeff[iWeight] += CosWeight*Weights[iWeight];
+	  SinCoeff[iWeight] += SinWeight*Weights[iWeight];
+	}
+      }
+    }
+  } catch (...) {
+    fOscParams[fDeltaCPIndex] = UserDeltaCP;
+    fDeltaCPHarmonicsValid = false;
+    throw;
+  }
+
+  fOscParams[fDeltaCPIndex] = UserDeltaCP;
+  fDeltaCPHarmonicsValid = true;
+}
+
+void OscProbCalcerBase::FillFromDeltaCPHarmonics(FLOAT_T DeltaCP) {
+  const FLOAT_T CosDeltaCP = cos(DeltaCP);
+  const FLOAT_T SinDeltaCP = sin(DeltaCP);
+
+  const FLOAT_T* A = fDeltaCPHarmonics[0].data();
+  const FLOAT_T* B = fDeltaCPHarmonics[1].data();
+  const FLOAT_T* C = fDeltaCPHarmonics[2].data();
+  FLOAT_T* Weights = fWeightArray.data();
+
+  if (fDeltaCPHarmonicOrder == 1) {
+#if UseMultithreading == 1
+#pragma omp parallel for simd
+#endif
+    for (int iWeight=0;iWeight<fNWeights;iWeight++) {
+      Weights[iWeight] = A[iWeight] + B[iWeight]*CosDeltaCP + C[iWeight]*SinDeltaCP;
+    }
+  } else {
+    const FLOAT_T Cos2DeltaCP = CosDeltaCP*CosDeltaCP-SinDeltaCP*SinDeltaCP;
+    const FLOAT_T Sin2DeltaCP = 2.*SinDeltaCP*CosDeltaCP;
+    const FLOAT_T* D = fDeltaCPHarmonics[3].data();
+    const FLOAT_T* E = fDeltaCPHarmonics[4].data();
+#if UseMultithreading == 1
+#pragma omp parallel for simd
+#endif
+    for (int iWeight=0;iWeight<fNWeights;iWeight++) {
+      Weights[iWeight] = A[iWeight] + B[iWeight]*CosDeltaCP + C[iWeight]*SinDeltaCP + D[iWeight]*Cos2DeltaCP + E[iWeight]*Sin2DeltaCP;
+    }
+  }
+}
+
 void OscProbCalcerBase::ResetCurrOscParams() {
   fOscParamsCurr = std::vector<FLOAT_T>(fNOscParams,DUMMYVAL);
 }
@@ -8,6 +8,11 @@
 
 #include "yaml-cpp/yaml.h"
 
+#ifdef __linux__
+#include <sched.h>
+#include <sys/types.h>
+#endif
+
 /**
  * @file OscProbCalcerBase.h
  *
@@ -58,7 +63,8 @@ class OscProbCalcerBase {
    * @brief General function used to call the oscillation probability calculation
    *
    * This function performs both the implementation specific CalculateProbabilities() function, along with checking whether the oscillation parameters have been
-   * updated since the last call. It also calls SanitiseProbabilities().
+   * updated since the last call. It also calls SanitiseProbabilities(), unless the implementation has already done so (see #fSanitisedInCalcer).
+   * If the delta_cp harmonic cache is enabled (see EnableDeltaCPCache()) and only delta_cp has changed, the probabilities are rebuilt from the cached coefficients instead.
    */
   void Reweight();
 
@@ -77,6 +83,22 @@ class OscProbCalcerBase {
    */
   void Reweight(const std::vector<FLOAT_T>& OscParams_);
 
+  /**
+   * @brief Return a copy of the current value of every oscillation parameter registered with DefineParameter(), in the order of the expected parameter names
+   *
+   * @return Copy of the oscillation parameter values
+   */
+  std::vector<FLOAT_T> ReturnOscParamsSnapshot();
+
+  /**
+   * @brief Reweight() using a copy of the oscillation parameters taken by ReturnOscParamsSnapshot(), rather than the values behind the registered pointers
+   *
+   * Allows the caller to change the registered values (e.g. prepare the next proposal) whilst this calculation runs on another thread
+   *
+   * @param OscParamsSnapshot Oscillation parameter values returned by ReturnOscParamsSnapshot()
+   */
+  void ReweightFromSnapshot(std::vector<FLOAT_T> OscParamsSnapshot);
+
   /**
    * @brief General function used to setup all variables used within the reweighting
    *
@@ -185,6 +207,21 @@ class OscProbCalcerBase {
    */
   std::vector<FLOAT_T> ReturnWeightArray() {return fWeightArray;}
 
+  /**
+   * @brief Return the number of bytes allocated for #fWeightArray, including any delta_cp harmonic cache
+   * @return Return the number of bytes allocated for the oscillation probabilities
+   */
+  long ReturnWeightArrayBytes();
+
+  /**
+   * @brief Return the number of bytes allocated for the evaluation points and any implementation specific lookup tables
+   *
+   * Implementations which build sizeable tables in SetupPropagator() should add them to the value returned by the base class
+   *
+   * @return Return the number of bytes allocated for lookup tables
+   */
+  virtual long ReturnLookupTableBytes();
+
   /**
    * @brief Return vector of oscillation probabilities with associated neutrin type, oscillation channel, Energy and CosineZ
    *
@@ -222,6 +259,45 @@ class OscProbCalcerBase {
    * Prints the current oscillation parameters which have been used in the calculation
    */
   void PrintOscParamsCurr();
+
+  /**
+   * @brief Return the number of threads used by Reweight()
+   * @return Return the number of threads used by Reweight()
+   */
+  int ReturnNThreads() {return fNThreads;}
+
+  /**
+   * @brief Set the number of threads used by Reweight(), instead of the global OpenMP setting
+   *
+   * Implementations which size per-thread resources in SetupPropagator() only accept a change before Setup(), and implementations which only support a single
+   * thread only accept 1. The "-CPU-N" suffix of the implementation name is updated
+   *
+   * @param NThreads Number of threads, at least 1
+   */
+  void SetNThreads(int NThreads);
+
+  /**
+   * @brief Return whether SetNThreads() currently accepts a different number of threads
+   * @return Return false for implementations which only support a single thread, and once Setup() has been called for implementations which size per-thread
+   * resources in SetupPropagator()
+   */
+  bool ReturnNThreadsAdjustable() {return !fSingleThreadOnly && !(fPropagatorSet && fNThreadsFixedAtSetup);}
+
+  /**
+   * @brief Bind the threads used by Reweight() to a set of CPUs (Linux only)
+   *
+   * Every thread of the team is allowed to run on any CPU of the set. The team is bound once, by Setup() or by a later change of the CPU set or of the number of
+   * threads, and keeps the binding until it changes again or the object is destroyed, which restores the previous affinity of every thread
+   *
+   * @param CPUSet CPU indices, an empty vector disables binding
+   */
+  void SetCPUSet(const std::vector<int>& CPUSet);
+
+  /**
+   * @brief Return whether Reweight() can run at the same time as Reweight() of another instance, i.e. the implementation keeps no global state
+   * @return Return whether Reweight() can run concurrently with other instances
+   */
+  bool ReturnConcurrentReweightSafe() {return fConcurrentReweightSafe;}
   
 
   // ========================================================================================================================================================================
@@ -312,6 +388,34 @@ class OscProbCalcerBase {
    */
   void SanitiseProbabilities();
 
+  /**
+   * @brief Clamp a block of oscillation probabilities into the [0.,1.] range in a single vectorised pass, applying the same #PrecisionLimit as SanitiseProbabilities()
+   *
+   * Intended for implementations which copy probabilities into #fWeightArray themselves and can fold the clamping into that copy. By default only values within
+   * #PrecisionLimit of the range are clamped. Any nan or value further outside is left untouched and, unless NoSanity has been requested, SanitiseProbabilities() is
+   * then called to report it. Implementations which use this for the whole of #fWeightArray should set
+   * #fSanitisedInCalcer such that Reweight() does not perform a second pass.
+   *
+   * @param Probs Pointer to the first probability to clamp
+   * @param nProbs Number of probabilities to clamp
+   * @param ClampAllButNan Clamp every value other than nan, however far outside the range, for engines known to return unphysical probabilities (e.g. single
+   * precision builds). Only a nan is then reported
+   */
+  void ClampProbabilities(FLOAT_T* Probs, long nProbs, bool ClampAllButNan=false);
+
+  /**
+   * @brief Declare that this implementation supports the delta_cp harmonic cache, which is then used if the config sets [OscProbCalcerSetup][DeltaCPCache]
+   *
+   * For fixed mixing angles, mass splittings and matter profile, delta_cp only enters through a rephasing of the mu/tau rows of the evolution operator. Every
+   * probability involving an electron (anti)neutrino is therefore exactly A + B cos(delta_cp) + C sin(delta_cp), and the remaining channels additionally carry
+   * cos(2 delta_cp) and sin(2 delta_cp) terms. With the cache enabled, Reweight() samples CalculateProbabilities() at 3 (or 5) equally spaced values of delta_cp
+   * whenever any other parameter changes and stores the harmonic coefficients of every entry of #fWeightArray. When only delta_cp changes, #fWeightArray is refilled
+   * from those coefficients in a single pass without any propagation. Only call this from implementations where delta_cp enters solely through the PMNS phase.
+   *
+   * @param DeltaCPIndex Index of delta_cp in the implementation's oscillation parameters
+   */
+  void EnableDeltaCPCache(int DeltaCPIndex);
+
   /**
    * @brief Return the index in #fCosineZArray for a particular value of CosineZ. If it's not found, throws an error
    *
@@ -496,10 +600,38 @@ class OscProbCalcerBase {
    */
   bool fCosineZIgnored;
 
+  /**
+   * @brief Flag to define whether the specific implementation already sanitises #fWeightArray within CalculateProbabilities(), such that Reweight() can skip SanitiseProbabilities()
+   */
+  bool fSanitisedInCalcer;
+
   /**
    * @brief YAML Config object used to get runtime specific variables
    */
   YAML::Node Config;
+
+  /**
+   * @brief Number of threads used by Reweight(). Set by 'OscProbCalcerSetup''Threads', otherwise the global OpenMP setting when the object is created
+   */
+  int fNThreads;
+
+  /**
+   * @brief Flag to define whether the specific implementation sizes per-thread resources (or a propagator) with #fNThreads in SetupPropagator(), such that it can
+   * not change afterwards
+   */
+  bool fNThreadsFixedAtSetup;
+
+  /**
+   * @brief Flag to define whether the specific implementation can be reweighted concurrently with other instances. Implementations which keep the oscillation
+   * parameters or probabilities in global state should set this to false
+   */
+  bool fConcurrentReweightSafe;
+
+  /**
+   * @brief Declare that the specific implementation only supports a single thread, e.g. because it keeps its state in globals. Called from the constructor of the
+   * specific implementation: sets #fNThreads to 1 and throws if 'OscProbCalcerSetup''Threads' requested more, after which SetNThreads() only accepts 1
+   */
+  void SetSingleThreadOnly();
   
  private:
   // ========================================================================================================================================================================
@@ -573,6 +705,115 @@ class OscProbCalcerBase {
    * @brief Boolean declaring whether the SanitiseProbabilities function should be called in the Reweight function. This should only be used for performance sensitive applications as when this is false, oscillation probabilities could be returned which are <0, >1, or nan 
    */
   bool fNoSanity;
+
+  /**
+   * @brief CPUs which the threads used by Reweight() are bound to. Set by 'OscProbCalcerSetup''CPUSet', empty if the threads are not bound
+   */
+  std::vector<int> fCPUSet;
+
+  /**
+   * @brief Flag declaring that the specific implementation only supports a single thread, see SetSingleThreadOnly()
+   */
+  bool fSingleThreadOnly;
+
+  /**
+   * @brief Bind the team of #fNThreads threads started by the calling thread to #fCPUSet, after restoring any previous binding
+   *
+   * Called by Setup(), and afterwards by SetNThreads() and SetCPUSet() when they change the setting, such that Reweight() does not bind on every call. Reweight()
+   * only binds again when it is called from another thread than the last binding (e.g. by CalculateProbabilitiesAsync()), as OpenMP then starts another team
+   */
+  void BindThreads();
+
+  /**
+   * @brief Restore the affinity which every thread bound by BindThreads() had before, by thread ID such that it can be called from any thread
+   */
+  void RestoreThreadAffinities();
+
+  /**
+   * @brief Return whether the team started by the calling thread is bound as requested by #fCPUSet, always true if no CPU set is requested
+   * @return Return whether BindThreads() needs to be called before the calculation
+   */
+  bool AreThreadsBound();
+
+#ifdef __linux__
+  /**
+   * @brief ID of the thread which started the bound team, 0 if no team is bound
+   */
+  pid_t fBindingThreadID;
+
+  /**
+   * @brief ID of every thread of the bound team
+   */
+  std::vector<pid_t> fBoundThreadIDs;
+
+  /**
+   * @brief Affinity of every thread of the bound team before it was bound
+   */
+  std::vector<cpu_set_t> fPreviousAffinities;
+
+  /**
+   * @brief Whether each thread of the bound team saved its previous affinity. Each thread writes its own element, so this is not a std::vector<bool>
+   */
+  std::vector<char> fAffinitySaved;
+#endif
+
+  /**
+   * @brief Applies #fNThreads as the OpenMP thread count of the calling thread for its lifetime within Reweight(), and restores the previous count afterwards,
+   * also when the calculation throws
+   */
+  class ThreadSettingsGuard {
+   public:
+    ThreadSettingsGuard(int NThreads);
+    ~ThreadSettingsGuard();
+
+    ThreadSettingsGuard(const ThreadSettingsGuard&) = delete;
+    ThreadSettingsGuard& operator=(const ThreadSettingsGuard&) = delete;
+
+   private:
+    int fPreviousNThreads;
+  };
+
+  /**
+   * @brief Config option "DeltaCPCache" requesting the delta_cp harmonic cache (see EnableDeltaCPCache())
+   */
+  bool fDeltaCPCacheRequested;
+
+  /**
+   * @brief Index of delta_cp in the oscillation parameters if the implementation supports the delta_cp harmonic cache, -1 otherwise
+   */
+  int fDeltaCPIndex;
+
+  /**
+   * @brief Highest harmonic of delta_cp in the requested channels: 1 if every channel involves an electron (anti)neutrino, 2 otherwise
+   */
+  int fDeltaCPHarmonicOrder;
+
+  /**
+   * @brief Whether #fDeltaCPHarmonics correspond to the non-delta_cp parameters saved in #fOscParamsCurr
+   */
+  bool fDeltaCPHarmonicsValid;
+
+  /**
+   * @brief Harmonic coefficients of every entry of #fWeightArray, ordered constant, cos(delta_cp), sin(delta_cp), cos(2 delta_cp), sin(2 delta_cp)
+   */
+  std::vector< std::vector<FLOAT_T> > fDeltaCPHarmonics;
+
+  /**
+   * @brief Check whether delta_cp is the only oscillation parameter which differs from those saved in #fOscParamsCurr
+   */
+  bool IsOnlyDeltaCPChanged();
+
+  /**
+   * @brief Evaluate CalculateProbabilities() at 2*#fDeltaCPHarmonicOrder+1 equally spaced values of delta_cp and store the harmonic coefficients of every entry of #fWeightArray
+   */
+  void CalculateDeltaCPHarmonics();
+
+  /**
+   * @brief Fill #fWeightArray from the harmonic coefficients for a particular value of delta_cp
+   *
+   * @param DeltaCP Value of delta_cp in radians
+   */
+  void FillFromDeltaCPHarmonics(FLOAT_T DeltaCP);
 };
 
 #endif
@@ -20,6 +20,14 @@
 #include "OscProbCalcer/OscProbCalcer_NuFASTLinear.h"
 #endif
 
+#if UseNativeLinear==1
+#include "OscProbCalcer/OscProbCalcer_NativeLinear.h"
+#endif
+
+#if UseNativeEarth==1
+#include "OscProbCalcer/OscProbCalcer_NativeEarth.h"
+#endif
+
 #if UseNuFASTEarth==1
 #include "OscProbCalcer/OscProbCalcer_NuFASTEarth.h"
 #endif
@@ -119,6 +127,28 @@ OscProbCalcerBase* OscProbCalcerFactory::CreateOscProbCalcer(YAML::Node OscProbC
 #endif
   }
 
+  else if (OscProbCalcerImplementationToCreate == "NativeLinear") {
+#if UseNativeLinear==1
+    OscProbCalcerNativeLinear* NativeLinear = new OscProbCalcerNativeLinear(OscProbCalcerConfig);
+    Calcer = (OscProbCalcerBase*)NativeLinear;
+    if (Verbose >= NuOscillator::INFO) {std::cout << "Initalised OscProbCalcer Implementation:" << Calcer->ReturnImplementationName() << " in OscProbCalcerFactory object" << std::endl;}
+#else
+    std::cerr << "OscProbCalcerFactory was requsted to create " << OscProbCalcerImplementationToCreate << " OscProbCalcer but Use" << OscProbCalcerImplementationToCreate << " is undefined. Indicates problem in setup" << std::endl;
+    throw std::runtime_error("Invalid setup");
+#endif
+  }
+
+  else if (OscProbCalcerImplementationToCreate == "NativeEarth") {
+#if UseNativeEarth==1
+    OscProbCalcerNativeEarth* NativeEarth = new OscProbCalcerNativeEarth(OscProbCalcerConfig);
+    Calcer = (OscProbCalcerBase*)NativeEarth;
+    if (Verbose >= NuOscillator::INFO) {std::cout << "Initalised OscProbCalcer Implementation:" << Calcer->ReturnImplementationName() << " in OscProbCalcerFactory object" << std::endl;}
+#else
+    std::cerr << "OscProbCalcerFactory was requsted to create " << OscProbCalcerImplementationToCreate << " OscProbCalcer but Use" << OscProbCalcerImplementationToCreate << " is undefined. Indicates problem in setup" << std::endl;
+    throw std::runtime_error("Invalid setup");
+#endif
+  }
+
   else if (OscProbCalcerImplementationToCreate == "NuFASTEarth") {
 #if UseNuFASTEarth==1
     OscProbCalcerNuFASTEarth* NuFASTEarth = new OscProbCalcerNuFASTEarth(OscProbCalcerConfig);
@@ -3,6 +3,10 @@
 #include <iostream>
 #include "CHIC.h"
 
+#if UseMultithreading == 1
+#include "omp.h"
+#endif
+
 OscProbCalcerCHICLinear::OscProbCalcerCHICLinear(YAML::Node Config_) : OscProbCalcerBase(Config_)
 {
   //=======
@@ -18,6 +22,10 @@ OscProbCalcerCHICLinear::OscProbCalcerCHICLinear(YAML::Node Config_) : OscProbCa
 
   // This implementation only considers linear propagation, thus no requirement to set cosineZ array
   IgnoreCosineZBinning(true);
+
+  // A propagator is created for each of the fNThreads threads in SetupPropagator()
+  nThreads = 1;
+  fNThreadsFixedAtSetup = true;
 }
 
 OscProbCalcerCHICLinear::~OscProbCalcerCHICLinear() {
@@ -25,9 +33,17 @@ OscProbCalcerCHICLinear::~OscProbCalcerCHICLinear() {
 }
 
 void OscProbCalcerCHICLinear::SetupPropagator() {
-  // Initialise engine for nu and nubar
-  chic_nu    = std::make_unique<CHIC>("neutrino");
-  chic_nubar = std::make_unique<CHIC>("antineutrino");
+  nThreads = fNThreads;
+  // Initialise engine for nu and nubar for each thread
+  chic_propagators.clear();
+  for (int iThread = 0; iThread < nThreads; ++iThread) {
+    for (int iNuType = 0; iNuType < fNNeutrinoTypes; ++iNuType) {
+      chic_propagators.push_back(std::make_unique<CHIC>((fNeutrinoTypes[iNuType] == Nu) ? "neutrino" : "antineutrino"));
+    }
+  }
+  fImplementationName += "-CPU-"+std::to_string(nThreads);
+
+  if (fVerbose >= NuOscillator::INFO) {std::cout << "Setup " << chic_propagators.size() << " CHIC propagators for:" << nThreads << " threads" << std::endl;}
 }
 
 void OscProbCalcerCHICLinear::CalculateProbabilities() {
@@ -39,40 +55,53 @@ void OscProbCalcerCHICLinear::CalculateProbabilities() {
     }
   }
 
-  for (int iNuType = 0; iNuType < fNNeutrinoTypes; ++iNuType) {
-    // KS: CHIC sets Nu and NuBar based on constructor those we switch between both
-    CHIC* chic_propagator = (fNeutrinoTypes[iNuType] == Nu) ? chic_nu.get() : chic_nubar.get();
-    // ------------------------------- //
-    // Set the experimental parameters //
-    // ------------------------------- //
-    const double Baseline = GetOscillationParameter(kPATHL); // km
-    const double rho = GetOscillationParameter(kDENS); // g/cc
-
-    // CHIC expects angles, not sin^2
-    chic_propagator->update_th12(std::asin(std::sqrt(GetOscillationParameter(kTH12))));
-    chic_propagator->update_th13(std::asin(std::sqrt(GetOscillationParameter(kTH13))));
-    chic_propagator->update_th23(std::asin(std::sqrt(GetOscillationParameter(kTH23))));
-
-    chic_propagator->update_dcp(GetOscillationParameter(kDCP));
-    chic_propagator->update_dm221(GetOscillationParameter(kDM12));
-    chic_propagator->update_dm231(GetOscillationParameter(kDM23) + GetOscillationParameter(kDM12));
+  // ------------------------------- //
+  // Set the experimental parameters //
+  // ------------------------------- //
+  const double Baseline = GetOscillationParameter(kPATHL); // km
+  const double rho = GetOscillationParameter(kDENS); // g/cc
+
+  // CHIC expects angles, not sin^2
+  const double th12 = std::asin(std::sqrt(GetOscillationParameter(kTH12)));
+  const double th13 = std::asin(std::sqrt(GetOscillationParameter(kTH13)));
+  const double th23 = std::asin(std::sqrt(GetOscillationParameter(kTH23)));
+  const double dcp = GetOscillationParameter(kDCP);
+  const double dm221 = GetOscillationParameter(kDM12);
+  const double dm231 = GetOscillationParameter(kDM23) + GetOscillationParameter(kDM12);
+
+  for (size_t iPropagator = 0; iPropagator < chic_propagators.size(); ++iPropagator) {
+    CHIC* chic_propagator = chic_propagators[iPropagator].get();
+    chic_propagator->update_th12(th12);
+    chic_propagator->update_th13(th13);
+    chic_propagator->update_th23(th23);
+    chic_propagator->update_dcp(dcp);
+    chic_propagator->update_dm221(dm221);
+    chic_propagator->update_dm231(dm231);
     chic_propagator->update_density(rho);
+  }
 
-    // KS: Do not multithread, compute_oscillations is mutable as it stores neutrino energy
-    // multihreading would break physics
+  // KS: compute_oscillations is mutable as it stores neutrino energy, so each thread uses its own propagator
+#if UseMultithreading == 1
+  #pragma omp parallel for collapse(2) schedule(static) num_threads(nThreads)
+#endif
+  for (int iNuType = 0; iNuType < fNNeutrinoTypes; ++iNuType) {
     for (int iOscProb = 0; iOscProb < fNEnergyPoints; ++iOscProb) {
+      int iThread = 0;
+#if UseMultithreading == 1
+      iThread = omp_get_thread_num();
+#endif
+      // KS: CHIC sets Nu and NuBar based on constructor those we switch between both
+      CHIC* chic_propagator = chic_propagators[iThread * fNNeutrinoTypes + iNuType].get();
       const double Energy = fEnergyArray[iOscProb];
 
       Eigen::Matrix3d prob = chic_propagator->compute_oscillations(Energy, Baseline);
+
+      FLOAT_T* Weights = &fWeightArray[iNuType * fNOscillationChannels * fNEnergyPoints + iOscProb];
       for (int iOscChannel = 0; iOscChannel < fNOscillationChannels; ++iOscChannel) {
         const int from = fOscillationChannels[iOscChannel].GeneratedFlavour - 1;
         const int to   = fOscillationChannels[iOscChannel].DetectedFlavour - 1;
 
-        const double Weight = prob(to, from);
-
-        const int IndexToFill = iNuType * fNOscillationChannels * fNEnergyPoints +
-                                 iOscChannel * fNEnergyPoints + iOscProb;
-        fWeightArray[IndexToFill] = Weight;
+        Weights[iOscChannel * fNEnergyPoints] = prob(to, from);
       }
     }
   }
@@ -87,9 +87,16 @@ class OscProbCalcerCHICLinear : public OscProbCalcerBase {
    */
   enum NuType{Nu=1,Nubar=-1};
 
-  // CHIC
-  std::unique_ptr<CHIC> chic_nu;
-  std::unique_ptr<CHIC> chic_nubar;
+  /**
+   * @brief Pool of CHIC propagators, one per thread and neutrino type (index iThread*fNNeutrinoTypes+iNuType), as CHIC sets Nu or NuBar in its constructor
+   * and compute_oscillations() stores the neutrino energy so can not be shared between threads
+   */
+  std::vector< std::unique_ptr<CHIC> > chic_propagators;
+
+  /**
+   * @brief The number of threads being used to perform the calculation
+   */
+  int nThreads;
 };
 
 #endif
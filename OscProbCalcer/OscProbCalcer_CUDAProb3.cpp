@@ -57,6 +57,7 @@ OscProbCalcerCUDAProb3::OscProbCalcerCUDAProb3(YAML::Node Config_) : OscProbCalc
   }
   //=======
   SetExpectedParameterNames(OscParNames);
+  EnableDeltaCPCache(kDCP);
   
   CopyArr = nullptr;
   fNNeutrinoTypes = 2;
@@ -83,6 +84,7 @@ OscProbCalcerCUDAProb3::OscProbCalcerCUDAProb3(YAML::Node Config_) : OscProbCalc
   }  
 
   nThreads = 1;
+  fNThreadsFixedAtSetup = true;
 }
 
 OscProbCalcerCUDAProb3::~OscProbCalcerCUDAProb3() {
@@ -97,10 +99,7 @@ void OscProbCalcerCUDAProb3::SetupPropagator() {
   fImplementationName += "-GPU";
 #else
 
-  nThreads = 1;
-#if UseMultithreading == 1
-  nThreads = omp_get_max_threads();
-#endif
+  nThreads = fNThreads;
 
   if (fVerbose >= NuOscillator::INFO) {std::cout << "Using CPU CUDAProb3 propagator with " << nThreads << " threads" << std::endl;}
   propagator = std::unique_ptr< Propagator< FLOAT_T > > ( new CpuPropagator<FLOAT_T>(fNCosineZPoints, fNEnergyPoints, nThreads)); // MultiThread CPU propagator
@@ -18,6 +18,7 @@ OscProbCalcerCUDAProb3Linear::OscProbCalcerCUDAProb3Linear(YAML::Node Config_) :
   //=======
   std::vector<std::string> OscParNames = {"sin2_th12","sin2_th23","sin2_th13","dm2_12","dm2_23","delta_cp","path_length","matter_density"};
   SetExpectedParameterNames(OscParNames);
+  EnableDeltaCPCache(kDCP);
 
   fNNeutrinoTypes = 2;
   InitialiseNeutrinoTypesArray(fNNeutrinoTypes);
@@ -45,7 +46,11 @@ OscProbCalcerCUDAProb3Linear::OscProbCalcerCUDAProb3Linear(YAML::Node Config_) :
   // This implementation only considers linear propagation, thus no requirement to set cosineZ array
   IgnoreCosineZBinning(true);
 
+  // Probabilities are clamped as they are written into fWeightArray, so Reweight() does not need a second pass
+  fSanitisedInCalcer = true;
+
   nThreads = 1;
+  fNThreadsFixedAtSetup = true;
 }
 
 
@@ -55,10 +60,7 @@ OscProbCalcerCUDAProb3Linear::~OscProbCalcerCUDAProb3Linear() {
 
 void OscProbCalcerCUDAProb3Linear::SetupPropagator() {
 
-  nThreads = 1;
-#if UseMultithreading == 1
-  nThreads = omp_get_max_threads();
-#endif
+  nThreads = fNThreads;
   
 #if UseGPU == 1
   if (fVerbose >= NuOscillator::INFO) {std::cout << "Using GPU CUDAProb3Linear propagator" << std::endl;}
@@ -97,10 +99,7 @@ void OscProbCalcerCUDAProb3Linear::CalculateProbabilities() {
   propagator->setDensity(Density);
   propagator->setPathLength(PathL);
 
-  // CUDAProb3Linear calculates oscillation probabilites for each NeutrinoType, so need to copy them from the calculator into fWeightArray
-  int CopyArrSize = fNEnergyPoints;
-  FLOAT_T* CopyArr = new FLOAT_T[CopyArrSize];
-
+  // CUDAProb3Linear calculates oscillation probabilites for each NeutrinoType, which are copied straight into the contiguous energy slice of fWeightArray
   for (int iNuType=0;iNuType<fNNeutrinoTypes;iNuType++) {
 
     int NuType_int;
@@ -117,22 +116,12 @@ void OscProbCalcerCUDAProb3Linear::CalculateProbabilities() {
     propagator->calculateProbabilities(NuType);
 
     for (int iOscChannel=0;iOscChannel<fNOscillationChannels;iOscChannel++) {
-      propagator->getProbabilityArr(CopyArr,static_cast<cudaprob3linear::ProbType>(OscChannels[iOscChannel]));
-	
-      // Mapping which links the oscillation channel, neutrino type and energy/cosineZ index to the fWeightArray index
-      int IndexToFill = iNuType*fNOscillationChannels*CopyArrSize + iOscChannel*CopyArrSize;
-      for (int iOscProb=0;iOscProb<CopyArrSize;iOscProb++) {
-	
-	// Sometimes CUDAProb3Linear can return *slightly* unphysical oscillation probabilities
-	CopyArr[iOscProb] = CopyArr[iOscProb] > 0.0 ? CopyArr[iOscProb] : 0.0;
-	CopyArr[iOscProb] = CopyArr[iOscProb] < 1.0 ? CopyArr[iOscProb] : 1.0;
-	
-	fWeightArray[IndexToFill+iOscProb] = CopyArr[iOscProb];
-      }
+      propagator->getProbabilityArr(&fWeightArray[ReturnWeightArrayIndex(iNuType,iOscChannel,0)],static_cast<cudaprob3linear::ProbType>(OscChannels[iOscChannel]));
     }
   }
 
-  delete[] CopyArr;
+  // Sometimes CUDAProb3Linear can return *slightly* unphysical oscillation probabilities, which have always been clamped whatever their size. Only a nan throws
+  ClampProbabilities(fWeightArray.data(),static_cast<long>(fWeightArray.size()),true);
 }
 
 int OscProbCalcerCUDAProb3Linear::ReturnWeightArrayIndex(int NuTypeIndex, int OscChanIndex, int EnergyIndex, int CosineZIndex) {
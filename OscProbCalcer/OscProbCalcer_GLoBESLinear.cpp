@@ -2,7 +2,6 @@
 
 #include <iostream>
 
-#include "globes/globes.h"
 #include "globes/glb-modules.h"
 // KS: Include the SNU header with C linkage to prevent C++ name mangling
 // This ensures that the functions in snu.h can be linked correctly when compiled in C++.
@@ -10,6 +9,13 @@ extern "C" {
   //#include "snu.h"
 }
 
+// Probability engine registered with glbRegisterProbabilityEngine() (the standard engine by default) and its user data, which glbConstantDensityProbability()
+// also calls through. GLoBES defines these globals but does not install the header declaring them
+extern "C" {
+  extern glb_probability_matrix_function glb_hook_probability_matrix;
+  extern void *glb_probability_user_data;
+}
+
 OscProbCalcerGLoBESLinear::OscProbCalcerGLoBESLinear(YAML::Node Config_) : OscProbCalcerBase(Config_)
 {
   //=======
@@ -21,18 +27,25 @@ OscProbCalcerGLoBESLinear::OscProbCalcerGLoBESLinear(YAML::Node Config_) : OscPr
   fNeutrinoTypes[0] = Nu;
   fNeutrinoTypes[1] = Nubar;
 
+  fGLoBESParams = nullptr;
+
+  // GLoBES keeps its state in globals so only a single thread is supported
+  SetSingleThreadOnly();
+  fConcurrentReweightSafe = false;
   fImplementationName += "-CPU-"+std::to_string(1);
   // This implementation only considers linear propagation, thus no requirement to set cosineZ array
   IgnoreCosineZBinning(true);
 }
 
 OscProbCalcerGLoBESLinear::~OscProbCalcerGLoBESLinear() {
-
+  if (fGLoBESParams != nullptr) {glbFreeParams(fGLoBESParams);}
 }
 
 void OscProbCalcerGLoBESLinear::SetupPropagator() {
   char name[] = "dummy";
   glbInit(name);
+
+  fGLoBESParams = glbAllocParams();
 }
 
 void OscProbCalcerGLoBESLinear::CalculateProbabilities() {
@@ -56,33 +69,41 @@ void OscProbCalcerGLoBESLinear::CalculateProbabilities() {
   const double Dmsq31 = GetOscillationParameter(kDM23) + GetOscillationParameter(kDM12); // eV^2
 
   // Set GLoBES oscillation parameters
-  glb_params true_values = glbAllocParams();
-  glbSetOscParams(true_values, theta12, GLB_THETA_12);
-  glbSetOscParams(true_values, theta13, GLB_THETA_13);
-  glbSetOscParams(true_values, theta23, GLB_THETA_23);
-  glbSetOscParams(true_values, delta, GLB_DELTA_CP);
-  glbSetOscParams(true_values, Dmsq21, GLB_DM_21);
-  glbSetOscParams(true_values, Dmsq31, GLB_DM_31);
-  glbSetOscillationParameters(true_values);
-
-  // Loop over energy and oscillation channels
-  // KS: WARNING according to manual it isn't thread safe...
+  glbSetOscParams(fGLoBESParams, theta12, GLB_THETA_12);
+  glbSetOscParams(fGLoBESParams, theta13, GLB_THETA_13);
+  glbSetOscParams(fGLoBESParams, theta23, GLB_THETA_23);
+  glbSetOscParams(fGLoBESParams, delta, GLB_DELTA_CP);
+  glbSetOscParams(fGLoBESParams, Dmsq21, GLB_DM_21);
+  glbSetOscParams(fGLoBESParams, Dmsq31, GLB_DM_31);
+  if (glbSetOscillationParameters(fGLoBESParams) != 0) {
+    std::cerr << "GLoBES probability engine rejected the oscillation parameters" << std::endl;
+    throw std::runtime_error("GLoBES probability calculation failed");
+  }
+
+  // glbConstantDensityProbability() builds the full 3x3 probability matrix and returns a single element of it, so call the registered probability engine
+  // the same way to solve the matter Hamiltonian once per energy and neutrino type and fill every requested channel from the same matrix
+  // KS: WARNING according to manual it isn't thread safe, the default engine uses static workspaces so the energy loop is kept serial
+  double P[3][3];
   for (int iEnergy = 0; iEnergy < fNEnergyPoints; ++iEnergy) {
     const double E = fEnergyArray[iEnergy];
-    for (int iChan = 0; iChan < fNOscillationChannels; ++iChan) {
-      for (int iNuType = 0; iNuType < fNNeutrinoTypes; ++iNuType) {
+    for (int iNuType = 0; iNuType < fNNeutrinoTypes; ++iNuType) {
+      int cp_sign = (iNuType == 0) ? +1 : -1; // neutrino vs antineutrino
+
+      int Status = glb_hook_probability_matrix(P, cp_sign, E, 1, &L, &rho, -1.0, glb_probability_user_data);
+      if (Status != GLB_SUCCESS) {
+        std::cerr << "GLoBES probability engine failed with status:" << Status << " at energy:" << E << " for cp_sign:" << cp_sign << std::endl;
+        throw std::runtime_error("GLoBES probability calculation failed");
+      }
+
+      for (int iChan = 0; iChan < fNOscillationChannels; ++iChan) {
         int alpha = fOscillationChannels[iChan].GeneratedFlavour;
         int beta  = fOscillationChannels[iChan].DetectedFlavour;
-        int cp_sign = (iNuType == 0) ? +1 : -1; // neutrino vs antineutrino
-
-        double P = glbConstantDensityProbability(alpha, beta, cp_sign, E, L, rho);
 
         int index = ReturnWeightArrayIndex(iNuType, iChan, iEnergy, 0);
-        fWeightArray[index] = P;
+        fWeightArray[index] = P[alpha-1][beta-1];
       }
     }
   }
-  glbFreeParams(true_values);
 }
 
 int OscProbCalcerGLoBESLinear::ReturnWeightArrayIndex(int NuTypeIndex, int OscChanIndex, int EnergyIndex, int CosineZIndex) {
@@ -3,6 +3,8 @@
 
 #include "OscProbCalcerBase.h"
 
+#include "globes/globes.h"
+
 /**
  * @file OscProbCalcer_GLoBESLinear.h
  *
@@ -84,6 +86,11 @@ class OscProbCalcerGLoBESLinear : public OscProbCalcerBase {
    * @brief Define the neutrino and antineutrino values expected by this implementation
    */
   enum NuType{Nu=1,Nubar=-1};
+
+  /**
+   * @brief GLoBES oscillation parameter object, allocated once in SetupPropagator() and re-used for every calculation
+   */
+  glb_params fGLoBESParams;
 };
 
 #endif
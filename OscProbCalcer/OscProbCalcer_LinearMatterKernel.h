@@ -0,0 +1,132 @@
+#ifndef __OSCILLATOR_LINEARMATTERKERNEL_H__
+#define __OSCILLATOR_LINEARMATTERKERNEL_H__
+
+#include <cmath>
+
+/**
+ * @file OscProbCalcer_LinearMatterKernel.h
+ *
+ * @brief Probability step shared by the vectorised kernels of OscProbCalcerNuFASTLinear and OscProbCalcerNativeLinear.
+ *
+ * Both engines solve three-flavour propagation through constant density matter and only differ in how the eigenvalues of the matter Hamiltonian are found:
+ * NuFAST refines lambda3 with Newton iterations whilst NativeLinear takes the trigonometric (Cardano) roots. Once the eigenvalues are known, the mixing matrix
+ * elements in matter follow from the eigenvector-eigenvalue identity and the nine probabilities are built here. The probabilities are only evaluated in the
+ * kernel files, which are built with -ffast-math.
+ */
+
+#if defined(__GNUC__) && !defined(__CUDACC__)
+#define LINEAR_MATTER_KERNEL_INLINE inline __attribute__((always_inline))
+#else
+#define LINEAR_MATTER_KERNEL_INLINE inline
+#endif
+
+namespace NuOscillator {
+
+  /**
+   * @brief Energy independent terms of the constant density Hamiltonian, evaluated once per reweight
+   *
+   * All mass splittings are in eV^2. The "ee" and "mm" minors are the 2x2 sub-matrices of the vacuum Hamiltonian obtained by removing the electron
+   * or muon row and column, which is what the eigenvector-eigenvalue identity needs.
+   */
+  template <typename T>
+  struct LinearMatterTerms {
+    T TraceVac;  // Dmsq21+Dmsq31
+    T DetVac;    // Dmsq21*Dmsq31, product of the non-zero vacuum eigenvalues
+    T See;       // Trace of the ee minor
+    T Tee;       // Determinant of the ee minor
+    T Hmm;       // Vacuum mu-mu element of the Hamiltonian
+    T Um1sq;     // |U_mu1|^2 in vacuum
+    T Jvac;      // 8*Jarlskog*Dmsq21*Dmsq31*Dmsq32
+    T YerhoE;    // Matter potential per GeV of neutrino energy
+    T LOver4;    // Path length including the conversion to GeV/eV^2
+  };
+
+  /**
+   * @brief The nine oscillation probabilities at one energy, named P<Generated><Detected>
+   */
+  template <typename T>
+  struct LinearMatterProbabilities {
+    T Pee, Pem, Pet;
+    T Pme, Pmm, Pmt;
+    T Pte, Ptm, Ptt;
+  };
+
+  /**
+   * @brief Calculate the nine probabilities at one energy from the eigenvalues of the matter Hamiltonian
+   *
+   * @param In Energy independent terms
+   * @param E Neutrino energy in GeV, negative for antineutrinos
+   * @param lambda2 Middle eigenvalue of the matter Hamiltonian
+   * @param lambda3 Largest eigenvalue of the matter Hamiltonian
+   * @param Dlambda21 lambda2-lambda1
+   * @param Dlambda32 lambda3-lambda2
+   *
+   * @return Probabilities of every oscillation channel
+   */
+  template <typename T>
+  LINEAR_MATTER_KERNEL_INLINE LinearMatterProbabilities<T> LinearMatterProbabilitiesFromEigenvalues(const LinearMatterTerms<T>& In, T E, T lambda2, T lambda3, T Dlambda21, T Dlambda32) {
+    const T Amatter = In.YerhoE*E;
+    const T A = In.TraceVac+Amatter;
+    const T Dlambda31 = Dlambda32+Dlambda21;
+
+    // Eigenvector-eigenvalue identity for the electron and muon rows of the mixing matrix in matter
+    const T PiDlambdaInv = 1/(Dlambda31*Dlambda32*Dlambda21);
+    const T Xp3 = PiDlambdaInv*Dlambda21;
+    const T Xp2 = -PiDlambdaInv*Dlambda31;
+
+    const T Ue3sq = (lambda3*(lambda3-In.See)+In.Tee)*Xp3;
+    const T Ue2sq = (lambda2*(lambda2-In.See)+In.Tee)*Xp2;
+
+    const T Smm = A-In.Hmm;
+    const T Tmm = In.DetVac*In.Um1sq+Amatter*(In.See+Smm-A);
+
+    const T Um3sq = (lambda3*(lambda3-Smm)+Tmm)*Xp3;
+    const T Um2sq = (lambda2*(lambda2-Smm)+Tmm)*Xp2;
+
+    const T Jmatter = In.Jvac*PiDlambdaInv;
+
+    const T Ue1sq = 1-Ue3sq-Ue2sq;
+    const T Um1sq = 1-Um3sq-Um2sq;
+    const T Ut3sq = 1-Um3sq-Ue3sq;
+    const T Ut2sq = 1-Um2sq-Ue2sq;
+    const T Ut1sq = 1-Um1sq-Ue1sq;
+
+    // Kinematic terms
+    const T LOver4E = In.LOver4/E;
+    const T D21 = Dlambda21*LOver4E;
+    const T D32 = Dlambda32*LOver4E;
+
+    const T sinD21 = std::sin(D21);
+    const T sinD31 = std::sin(D32+D21);
+    const T sinD32 = std::sin(D32);
+
+    const T triple_sin = sinD21*sinD31*sinD32;
+
+    const T sinsqD21_2 = 2*sinD21*sinD21;
+    const T sinsqD31_2 = 2*sinD31*sinD31;
+    const T sinsqD32_2 = 2*sinD32*sinD32;
+
+    // Calculate the three necessary probabilities, separating CPC and CPV
+    const T Pme_CPC = (Ut3sq-Um2sq*Ue1sq-Um1sq*Ue2sq)*sinsqD21_2
+                    + (Ut2sq-Um3sq*Ue1sq-Um1sq*Ue3sq)*sinsqD31_2
+                    + (Ut1sq-Um3sq*Ue2sq-Um2sq*Ue3sq)*sinsqD32_2;
+    const T Pme_CPV = -Jmatter*triple_sin;
+
+    LinearMatterProbabilities<T> P;
+    P.Pmm = 1-2*(Um2sq*Um1sq*sinsqD21_2+Um3sq*Um1sq*sinsqD31_2+Um3sq*Um2sq*sinsqD32_2);
+    P.Pee = 1-2*(Ue2sq*Ue1sq*sinsqD21_2+Ue3sq*Ue1sq*sinsqD31_2+Ue3sq*Ue2sq*sinsqD32_2);
+
+    // Remaining probabilities follow from unitarity
+    P.Pem = Pme_CPC-Pme_CPV;
+    P.Pme = Pme_CPC+Pme_CPV;
+    P.Pet = 1-P.Pee-P.Pem;
+    P.Pmt = 1-P.Pme-P.Pmm;
+    P.Pte = 1-P.Pee-P.Pme;
+    P.Ptm = 1-P.Pem-P.Pmm;
+    P.Ptt = 1-P.Pet-P.Pmt;
+    return P;
+  }
+
+}
+
+#endif
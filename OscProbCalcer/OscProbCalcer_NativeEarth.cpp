@@ -0,0 +1,342 @@
+#include "OscProbCalcer_NativeEarth.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+#if UseMultithreading == 1
+#include "omp.h"
+#endif
+
+namespace {
+  // Matter potential per GeV of neutrino energy per g/cm^3 of electron density, and the phase per eV^2 km/GeV
+  const double YerhoE2a = 1.52588e-4;
+  const double eVsqkm_to_GeV_over2 = 1e-9 / 1.97327e-7 * 1e3 / 2;
+
+  OscProbCalcerNativeEarth::NativeEarthHamiltonian BuildHamiltonian(double s12sq, double s13sq, double s23sq, double delta, double Dmsq21, double Dmsq31, bool IsAntiNeutrino) {
+    typedef std::complex<double> C;
+
+    const double s12 = sqrt(s12sq), c12 = sqrt(1-s12sq);
+    const double s13 = sqrt(s13sq), c13 = sqrt(1-s13sq);
+    const double s23 = sqrt(s23sq), c23 = sqrt(1-s23sq);
+    // Antineutrinos see the complex conjugate of the mixing matrix
+    const C eid = std::polar(1.0,IsAntiNeutrino ? -delta : delta);
+
+    const C U[3][3] = {{C(c12*c13), C(s12*c13), s13*std::conj(eid)},
+                       {-s12*c23-c12*s23*s13*eid, c12*c23-s12*s23*s13*eid, C(s23*c13)},
+                       {s12*s23-c12*c23*s13*eid, -c12*s23-s12*c23*s13*eid, C(c23*c13)}};
+    const double Masses[3] = {0., Dmsq21, Dmsq31};
+
+    C M[3][3];
+    for (int a=0;a<3;a++) {
+      for (int b=0;b<3;b++) {
+        M[a][b] = 0.;
+        for (int i=0;i<3;i++) {
+          M[a][b] += U[a][i]*Masses[i]*std::conj(U[b][i]);
+        }
+      }
+    }
+
+    C Q[3][3];
+    for (int a=0;a<3;a++) {
+      for (int b=0;b<3;b++) {
+        Q[a][b] = 0.;
+        for (int i=0;i<3;i++) {
+          Q[a][b] += M[a][i]*M[i][b];
+        }
+      }
+    }
+
+    OscProbCalcerNativeEarth::NativeEarthHamiltonian H;
+    H.M00 = M[0][0].real(); H.M11 = M[1][1].real(); H.M22 = M[2][2].real();
+    H.M01r = M[0][1].real(); H.M01i = M[0][1].imag();
+    H.M02r = M[0][2].real(); H.M02i = M[0][2].imag();
+    H.M12r = M[1][2].real(); H.M12i = M[1][2].imag();
+    H.Q00 = Q[0][0].real(); H.Q11 = Q[1][1].real(); H.Q22 = Q[2][2].real();
+    H.Q01r = Q[0][1].real(); H.Q01i = Q[0][1].imag();
+    H.Q02r = Q[0][2].real(); H.Q02i = Q[0][2].imag();
+    H.Q12r = Q[1][2].real(); H.Q12i = Q[1][2].imag();
+    H.Trace = Dmsq21+Dmsq31;
+    H.Minors = Dmsq21*Dmsq31;
+    H.See = H.M11+H.M22;
+    H.Tee = H.M11*H.M22-std::norm(M[1][2]);
+    return H;
+  }
+}
+
+OscProbCalcerNativeEarth::OscProbCalcerNativeEarth(YAML::Node Config_) : OscProbCalcerBase(Config_)
+{
+  //=======
+  //Grab information from the config
+  if (!Config_["OscProbCalcerSetup"]["EarthModelFileName"]) {
+    std::cerr << "Expected to find a 'EarthModelFileName' Node within the 'OscProbCalcerSetup' Node" << std::endl;
+    throw std::runtime_error("YAML node not found");
+  }
+  EarthModelFile = Config_["OscProbCalcerSetup"]["EarthModelFileName"].as<std::string>();
+
+  if (!Config_["OscProbCalcerSetup"]["DetDepth"]) {
+    std::cerr << "Expected to find a 'DetDepth' Node within the 'OscProbCalcerSetup' Node" << std::endl;
+    throw std::runtime_error("YAML node not found");
+  }
+  DetectorDepth = Config_["OscProbCalcerSetup"]["DetDepth"].as<double>();
+
+  UseEarthModelSystematics = false;
+  if (Config_["OscProbCalcerSetup"]["UseEarthModelSystematics"]) {
+    UseEarthModelSystematics = Config_["OscProbCalcerSetup"]["UseEarthModelSystematics"].as<bool>();
+  }
+
+  // The number of layers sets the number of systematic parameters, so the model is needed before the parameter names are defined
+  ReadEarthModel();
+
+  std::vector<std::string> OscParNames = {"sin2_th12","sin2_th23","sin2_th13","dm2_12","dm2_23","delta_cp","production_height"};
+  if (UseEarthModelSystematics) {
+    if (Config_["OscProbCalcerSetup"]["Layers"] && Config_["OscProbCalcerSetup"]["Layers"].as<int>() != nLayers) {
+      std::cerr << "Number of layers set in config differs from the one in " << EarthModelFile << std::endl;
+      std::cerr << "Expected: " << Config_["OscProbCalcerSetup"]["Layers"].as<int>() << "    Got: " << nLayers << std::endl;
+      throw std::runtime_error("Invalid setup");
+    }
+
+    for (int iLayer=0;iLayer<nLayers;iLayer++) {
+      OscParNames.push_back("r_"+std::to_string(iLayer));
+    }
+    for (int iLayer=0;iLayer<nLayers;iLayer++) {
+      OscParNames.push_back("w_"+std::to_string(iLayer));
+    }
+    for (int iLayer=0;iLayer<nLayers;iLayer++) {
+      OscParNames.push_back("y_"+std::to_string(iLayer));
+    }
+  }
+  //=======
+  SetExpectedParameterNames(OscParNames);
+  EnableDeltaCPCache(kDCP);
+
+  fNNeutrinoTypes = 2;
+  InitialiseNeutrinoTypesArray(fNNeutrinoTypes);
+  fNeutrinoTypes[0] = Nu;
+  fNeutrinoTypes[1] = Nubar;
+
+#if UseMultithreading == 1
+  fImplementationName += "-CPU-"+std::to_string(fNThreads);
+#else
+  fImplementationName += "-CPU-"+std::to_string(1);
+#endif
+
+  if (fVerbose >= NuOscillator::INFO) {
+    std::cout << "Earth model : " << EarthModelFile << " (" << nLayers << " layers)" << std::endl;
+    std::cout << "Detector depth : " << DetectorDepth << "km" << std::endl;
+  }
+}
+
+OscProbCalcerNativeEarth::~OscProbCalcerNativeEarth() {
+
+}
+
+void OscProbCalcerNativeEarth::ReadEarthModel() {
+  std::ifstream File(EarthModelFile);
+  if (!File) {
+    std::cerr << "Could not open Earth model:" << EarthModelFile << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+
+  std::vector<double> Radii, Densities, ZoA;
+  std::string Line;
+  while (std::getline(File,Line)) {
+    if (Line.empty() || Line[0] == '#') continue;
+    std::istringstream Stream(Line);
+    double Radius, Density, Z;
+    if (!(Stream >> Radius >> Density >> Z)) continue;
+    Radii.push_back(Radius);
+    Densities.push_back(Density);
+    ZoA.push_back(Z);
+  }
+
+  if (Radii.size() < 2) {
+    std::cerr << "Expected at least one Earth layer and the atmosphere in " << EarthModelFile << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+
+  for (size_t iLayer=1;iLayer<Radii.size();iLayer++) {
+    if (Radii[iLayer] <= Radii[iLayer-1]) {
+      std::cerr << "Layer radii in " << EarthModelFile << " should be strictly increasing" << std::endl;
+      throw std::runtime_error("Invalid setup");
+    }
+  }
+
+  // The last entry is the atmosphere, whose thickness is set by the production height
+  nLayers = static_cast<int>(Radii.size())-1;
+  LayerRadii = std::vector<double>(Radii.begin(),Radii.end()-1);
+  LayerDensities = std::vector<double>(Densities.begin(),Densities.end()-1);
+  LayerZoA = std::vector<double>(ZoA.begin(),ZoA.end()-1);
+  AtmosphereDensity = Densities.back();
+  AtmosphereZoA = ZoA.back();
+
+  if (DetectorDepth < 0 || DetectorDepth >= LayerRadii.back()) {
+    std::cerr << "Invalid detector depth:" << DetectorDepth << "km for an Earth radius of " << LayerRadii.back() << "km" << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+}
+
+void OscProbCalcerNativeEarth::SetupPropagator() {
+  SegmentGeometry.clear();
+  UpdatePathSegments(0.,LayerRadii);
+}
+
+void OscProbCalcerNativeEarth::UpdatePathSegments(double ProductionHeight, const std::vector<double>& Radii) {
+  std::vector<double> Geometry(1,ProductionHeight);
+  Geometry.insert(Geometry.end(),Radii.begin(),Radii.end());
+  if (Geometry == SegmentGeometry) return;
+
+  for (size_t iLayer=1;iLayer<Radii.size();iLayer++) {
+    if (Radii[iLayer] <= Radii[iLayer-1]) {
+      std::cerr << "Layer radii should be strictly increasing, found r_" << iLayer-1 << "=" << Radii[iLayer-1] << " and r_" << iLayer << "=" << Radii[iLayer] << std::endl;
+      throw std::runtime_error("Invalid setup");
+    }
+  }
+  if (ProductionHeight < 0) {
+    std::cerr << "Invalid production height:" << ProductionHeight << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+
+  CalculatePathSegments(ProductionHeight,Radii);
+  SegmentGeometry = Geometry;
+}
+
+void OscProbCalcerNativeEarth::CalculatePathSegments(double ProductionHeight, const std::vector<double>& Radii) {
+  const double SurfaceRadius = Radii.back();
+  const double DetectorRadius = SurfaceRadius-DetectorDepth;
+  const double ProductionRadius = SurfaceRadius+ProductionHeight;
+
+  SegmentOffsets.assign(1,0);
+  SegmentLengths.clear();
+  SegmentLayers.clear();
+
+  for (int iCosineZ=0;iCosineZ<fNCosineZPoints;iCosineZ++) {
+    // Distance s from the detector towards the production point is at radius r(s)^2 = DetectorRadius^2 + s^2 + 2*s*DetectorRadius*CosineZ
+    const double b = DetectorRadius*fCosineZArray[iCosineZ];
+    const double Offset = b*b-DetectorRadius*DetectorRadius;
+    const double PathLength = -b+sqrt(Offset+ProductionRadius*ProductionRadius);
+
+    std::vector<double> Crossings = {0.,PathLength};
+    for (int iLayer=0;iLayer<nLayers;iLayer++) {
+      const double Discriminant = Offset+Radii[iLayer]*Radii[iLayer];
+      if (Discriminant <= 0) continue;
+      for (double s : {-b-sqrt(Discriminant),-b+sqrt(Discriminant)}) {
+        if (s > 0 && s < PathLength) Crossings.push_back(s);
+      }
+    }
+    std::sort(Crossings.begin(),Crossings.end());
+
+    // Walk back from the production point to the detector, merging neighbouring pieces of the same layer
+    int PreviousLayer = -1;
+    for (int iCrossing=static_cast<int>(Crossings.size())-1;iCrossing>0;iCrossing--) {
+      const double Length = Crossings[iCrossing]-Crossings[iCrossing-1];
+      if (Length <= 0) continue;
+
+      const double Midpoint = 0.5*(Crossings[iCrossing]+Crossings[iCrossing-1]);
+      const double Radius = sqrt(std::max(0.,(Midpoint+b)*(Midpoint+b)-Offset));
+      const int Layer = static_cast<int>(std::lower_bound(Radii.begin(),Radii.end(),Radius)-Radii.begin());
+
+      if (Layer == PreviousLayer) {
+        SegmentLengths.back() += Length;
+      } else {
+        SegmentLengths.push_back(Length);
+        SegmentLayers.push_back(Layer);
+        PreviousLayer = Layer;
+      }
+    }
+    SegmentOffsets.push_back(static_cast<int>(SegmentLengths.size()));
+  }
+
+  if (fVerbose >= NuOscillator::INFO) {
+    std::cout << "Built " << SegmentLengths.size() << " path segments for " << fNCosineZPoints << " cosine zenith points with production height " << ProductionHeight << "km" << std::endl;
+  }
+}
+
+void OscProbCalcerNativeEarth::CalculateProbabilities() {
+  const double s12sq = GetOscillationParameter(kTH12);
+  const double s13sq = GetOscillationParameter(kTH13);
+  const double s23sq = GetOscillationParameter(kTH23);
+  const double delta = GetOscillationParameter(kDCP);
+  const double Dmsq21 = GetOscillationParameter(kDM12);
+
+  //Need to convert fOscParams[kDM23] to kDM31
+  const double Dmsq31 = GetOscillationParameter(kDM23)+GetOscillationParameter(kDM12); // eV^2
+
+  // ------------------------------------------------------------------ //
+  // Geometry is only rebuilt when the production height or a layer     //
+  // boundary moves, densities and compositions are applied per reweight //
+  // ------------------------------------------------------------------ //
+  const int kLayerBoundaries = kPRODH+1;
+  const int kLayerWeights = kLayerBoundaries+nLayers;
+  const int kLayerYps = kLayerWeights+nLayers;
+
+  std::vector<double> Radii = LayerRadii;
+  std::vector<double> LayerPotentials(nLayers+1);
+  for (int iLayer=0;iLayer<nLayers;iLayer++) {
+    double Density = LayerDensities[iLayer];
+    double ZoA = LayerZoA[iLayer];
+    if (UseEarthModelSystematics) {
+      Radii[iLayer] = GetOscillationParameter(kLayerBoundaries+iLayer);
+      Density *= GetOscillationParameter(kLayerWeights+iLayer);
+      ZoA = GetOscillationParameter(kLayerYps+iLayer);
+    }
+    LayerPotentials[iLayer] = YerhoE2a*Density*ZoA;
+  }
+  LayerPotentials[nLayers] = YerhoE2a*AtmosphereDensity*AtmosphereZoA;
+
+  UpdatePathSegments(GetOscillationParameter(kPRODH),Radii);
+
+  const NativeEarthHamiltonian Hamiltonians[2] = {BuildHamiltonian(s12sq,s13sq,s23sq,delta,Dmsq21,Dmsq31,fNeutrinoTypes[0]==Nubar),
+                                                  BuildHamiltonian(s12sq,s13sq,s23sq,delta,Dmsq21,Dmsq31,fNeutrinoTypes[1]==Nubar)};
+
+  const int nEnergyBlocks = (fNEnergyPoints+kEnergyBlockSize-1)/kEnergyBlockSize;
+
+  #if UseMultithreading == 1
+  #pragma omp parallel for collapse(3) schedule(dynamic,1) num_threads(fNThreads)
+  #endif
+  for (int iNuType=0;iNuType<fNNeutrinoTypes;iNuType++) {
+    for (int iCosineZ=0;iCosineZ<fNCosineZPoints;iCosineZ++) {
+      for (int iBlock=0;iBlock<nEnergyBlocks;iBlock++) {
+        const int BlockStart = iBlock*kEnergyBlockSize;
+        const int nBlockEnergies = std::min(kEnergyBlockSize,fNEnergyPoints-BlockStart);
+
+        double AmpRe[9][kEnergyBlockSize];
+        double AmpIm[9][kEnergyBlockSize];
+
+        for (int iSegment=SegmentOffsets[iCosineZ];iSegment<SegmentOffsets[iCosineZ+1];iSegment++) {
+          ApplySegment(Hamiltonians[iNuType], fNeutrinoTypes[iNuType]*LayerPotentials[SegmentLayers[iSegment]], eVsqkm_to_GeV_over2*SegmentLengths[iSegment],
+                       &fEnergyArray[BlockStart], nBlockEnergies, AmpRe, AmpIm, iSegment==SegmentOffsets[iCosineZ]);
+        }
+
+        for (int iOscChannel=0;iOscChannel<fNOscillationChannels;iOscChannel++) {
+          const int iAmp = 3*(fOscillationChannels[iOscChannel].DetectedFlavour-1)+(fOscillationChannels[iOscChannel].GeneratedFlavour-1);
+          FLOAT_T* Weights = &fWeightArray[ReturnWeightArrayIndex(iNuType,iOscChannel,BlockStart,iCosineZ)];
+
+          #if UseMultithreading == 1
+          #pragma omp simd
+          #endif
+          for (int iEnergy=0;iEnergy<nBlockEnergies;iEnergy++) {
+            Weights[iEnergy] = AmpRe[iAmp][iEnergy]*AmpRe[iAmp][iEnergy]+AmpIm[iAmp][iEnergy]*AmpIm[iAmp][iEnergy];
+          }
+        }
+      }
+    }
+  }
+}
+
+int OscProbCalcerNativeEarth::ReturnWeightArrayIndex(int NuTypeIndex, int OscChanIndex, int EnergyIndex, int CosineZIndex) {
+  int IndexToReturn = ((NuTypeIndex*fNOscillationChannels + OscChanIndex)*fNCosineZPoints + CosineZIndex)*fNEnergyPoints + EnergyIndex;
+  return IndexToReturn;
+}
+
+long OscProbCalcerNativeEarth::DefineWeightArraySize() {
+  long nCalculationPoints = static_cast<long>(fNEnergyPoints) * fNCosineZPoints * fNOscillationChannels * fNNeutrinoTypes;
+  return nCalculationPoints;
+}
+
+long OscProbCalcerNativeEarth::ReturnLookupTableBytes() {
+  return OscProbCalcerBase::ReturnLookupTableBytes()+SegmentOffsets.capacity()*sizeof(int)+SegmentLengths.capacity()*sizeof(double)+SegmentLayers.capacity()*sizeof(int);
+}
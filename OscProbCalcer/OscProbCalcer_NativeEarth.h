@@ -0,0 +1,213 @@
+#ifndef __OSCILLATOR_NATIVEEARTH_H__
+#define __OSCILLATOR_NATIVEEARTH_H__
+
+#include "OscProbCalcerBase.h"
+
+/**
+ * @file OscProbCalcer_NativeEarth.h
+ *
+ * @class OscProbCalcerNativeEarth
+ *
+ * @brief Built-in oscillation calculation engine for three-flavour atmospheric propagation through a layered Earth.
+ *
+ * The path through the Earth model for every entry of #fCosineZArray is split into constant density segments once, and only rebuilt when the production
+ * height or the layer boundaries change. Each reweight multiplies the evolution operators of those segments, evaluated in closed form and vectorised
+ * over blocks of energies.
+ */
+class OscProbCalcerNativeEarth : public OscProbCalcerBase {
+ public:
+
+  /**
+   * @brief Default constructor
+   *
+   * @param Config_ YAML::Node to setup the OscProbCalcerNativeEarth() instance
+   */
+  OscProbCalcerNativeEarth(YAML::Node Config_);
+
+  /**
+   * @brief Constructor which takes a file path, creates a YAML::Node and calls the default constructor
+   *
+   * @param ConfigName_ File path to config
+   */
+  OscProbCalcerNativeEarth(std::string ConfigName_) : OscProbCalcerNativeEarth(YAML::LoadFile(ConfigName_)) {}
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~OscProbCalcerNativeEarth();
+
+  // ========================================================================================================================================================================
+  // Functions which need implementation specific code
+
+  /**
+   * @brief Setup NativeEarth specific variables
+   *
+   * Reads the Earth model and builds the path segments for the default production height
+   */
+  void SetupPropagator() override;
+
+  /**
+   * @brief Calculate some oscillation probabilities for a particular oscillation parameter set
+   *
+   * All nine probabilities are evaluated together for each (neutrino type, cosine zenith, energy block), and the requested channels are written straight into #fWeightArray.
+   */
+  void CalculateProbabilities() override;
+
+  /**
+   * @brief Return implementation specific index in the weight array for a specific combination of neutrino oscillation channel, energy and cosine zenith
+   *
+   * @param NuTypeIndex The index in #fNeutrinoTypes (neutrino/antinuetrino) to return the pointer for
+   * @param OscChanIndex The index in #fOscillationChannels to return the pointer for
+   * @param EnergyIndex The index in #fEnergyArray to return the pointer for
+   * @param CosineZIndex The index in #fCosineZArray to return the pointer for
+   *
+   * @return Index in #fWeightArray which corresponds to the given inputs
+   */
+  int ReturnWeightArrayIndex(int NuTypeIndex, int OscNuIndex, int EnergyIndex, int CosineZIndex=-1) override;
+
+  /**
+   * @brief Define the size of fWeightArray
+   *
+   * @return Length that #fWeightArray should be initialised to
+   */
+  long DefineWeightArraySize() override;
+
+  /**
+   * @brief Return the number of bytes allocated for the evaluation points and the path segment tables
+   */
+  long ReturnLookupTableBytes() override;
+
+  // ========================================================================================================================================================================
+  // Functions which help setup implementation specific code
+
+  /**
+   * @brief Read the layer radii, densities and Z/A from #EarthModelFile
+   */
+  void ReadEarthModel();
+
+  /**
+   * @brief Rebuild the path segments if the production height or any layer boundary differs from the values used to build them
+   *
+   * @param ProductionHeight Production height above the surface in km
+   * @param Radii Outer radius of each Earth layer in km, innermost first
+   */
+  void UpdatePathSegments(double ProductionHeight, const std::vector<double>& Radii);
+
+  /**
+   * @brief Split the straight path from the production point to the detector into constant density segments for every entry of #fCosineZArray
+   *
+   * @param ProductionHeight Production height above the surface in km
+   * @param Radii Outer radius of each Earth layer in km, innermost first
+   */
+  void CalculatePathSegments(double ProductionHeight, const std::vector<double>& Radii);
+
+  // ========================================================================================================================================================================
+  // Variables which are needed for implementation specific code
+
+  /**
+   * @brief Definition of oscillation parameters which are expected in this implementation. Layer systematics (r_i, w_i, y_i) follow kPRODH
+   */
+  enum OscParams{kTH12, kTH23, kTH13, kDM12, kDM23, kDCP, kPRODH, kNOscParams};
+
+  /**
+   * @brief Define the neutrino and antineutrino values expected by this implementation
+   */
+  enum NuType{Nu=1,Nubar=-1};
+
+  /**
+   * @brief Path to the Earth model. Each line holds the outer radius [km], density [g/cm^3] and Z/A of a layer, innermost first. The last line is the atmosphere
+   */
+  std::string EarthModelFile;
+
+  /**
+   * @brief Depth of the detector below the surface in km
+   */
+  double DetectorDepth;
+
+  /**
+   * @brief Option to apply the r_i, w_i and y_i density model systematics
+   */
+  bool UseEarthModelSystematics;
+
+  /**
+   * @brief Number of Earth layers, not counting the atmosphere
+   */
+  int nLayers;
+
+  /**
+   * @brief Nominal outer radius [km], density [g/cm^3] and Z/A of each Earth layer, innermost first
+   */
+  std::vector<double> LayerRadii;
+  std::vector<double> LayerDensities;
+  std::vector<double> LayerZoA;
+
+  /**
+   * @brief Density [g/cm^3] and Z/A of the atmosphere, which extends from the surface to the production height
+   */
+  double AtmosphereDensity;
+  double AtmosphereZoA;
+
+  /**
+   * @brief Production height and layer radii which #SegmentLengths and #SegmentLayers were built with
+   */
+  std::vector<double> SegmentGeometry;
+
+  /**
+   * @brief Index of the first segment of each entry of #fCosineZArray, with a final entry holding the total number of segments
+   */
+  std::vector<int> SegmentOffsets;
+
+  /**
+   * @brief Length [km] of each segment, ordered from the production point to the detector
+   */
+  std::vector<double> SegmentLengths;
+
+  /**
+   * @brief Layer index of each segment, where nLayers is the atmosphere
+   */
+  std::vector<int> SegmentLayers;
+
+  /**
+   * @brief Number of energies evaluated together when multiplying the segment evolution operators
+   */
+  static constexpr int kEnergyBlockSize = 64;
+
+  /**
+   * @brief Energy independent terms of the vacuum Hamiltonian M = U diag(0,Dmsq21,Dmsq31) U^dagger of one neutrino type, in eV^2
+   *
+   * Only the upper triangle of M and M^2 is stored since both are Hermitian. The matter potential only enters the electron-electron element of the
+   * Hamiltonian, so H^2 and the coefficients of the characteristic polynomial are cheap updates of these.
+   */
+  struct NativeEarthHamiltonian {
+    double M00, M11, M22;
+    double M01r, M01i, M02r, M02i, M12r, M12i;
+    double Q00, Q11, Q22;
+    double Q01r, Q01i, Q02r, Q02i, Q12r, Q12i;
+    double Trace;  // Trace of M
+    double Minors; // Sum of the principal 2x2 minors of M
+    double See;    // Trace of the ee minor
+    double Tee;    // Determinant of the ee minor
+  };
+
+  /**
+   * @brief Multiply the amplitude matrices of a block of energies by the evolution operator of one constant density segment
+   *
+   * The operator exp(-iHL/2E) is built from Sylvester's formula, S = c2*H^2 + c1*H + c0, where the eigenvalues of H come from the trigonometric form of
+   * Cardano's formula. The common phase exp(-i(TrH/3)L/2E) is dropped as it does not change any probability. Defined in OscProbCalcer_NativeEarthKernel.cpp,
+   * the only file of this implementation built with -ffast-math
+   *
+   * @param H Vacuum Hamiltonian terms for this neutrino type
+   * @param Potential Matter potential of the segment per GeV of neutrino energy, negative for antineutrinos
+   * @param Length Segment length multiplied by the eV^2 km/GeV phase conversion
+   * @param Energy Array of nEnergy energies in GeV
+   * @param nEnergy Number of energies to evaluate, at most #kEnergyBlockSize
+   * @param AmpRe Real part of the amplitude matrix, stored as [3*DetectedFlavour+GeneratedFlavour][iEnergy] (zero-indexed)
+   * @param AmpIm Imaginary part of the amplitude matrix, with the same layout as AmpRe
+   * @param First Whether this is the first segment, in which case the amplitude matrix is set rather than multiplied
+   */
+  static void ApplySegment(const NativeEarthHamiltonian& H, double Potential, double Length, const FLOAT_T* __restrict__ Energy, int nEnergy,
+                           double (* __restrict__ AmpRe)[kEnergyBlockSize], double (* __restrict__ AmpIm)[kEnergyBlockSize], bool First);
+
+};
+
+#endif
@@ -0,0 +1,117 @@
+#include "OscProbCalcer_NativeEarth.h"
+
+#include <algorithm>
+#include <cmath>
+
+// This file only holds the vectorised kernel, as it is built with -ffast-math (see OscProbCalcer/CMakeLists.txt) whilst the rest of the implementation is not
+
+// Build the vectorised kernel for AVX-512, AVX2 and baseline x86-64. The dynamic loader picks the best version for the CPU being used
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__CUDACC__) && defined(__x86_64__)
+#define NATIVEEARTH_KERNEL_DISPATCH __attribute__((target_clones("arch=skylake-avx512","arch=haswell","default")))
+#else
+#define NATIVEEARTH_KERNEL_DISPATCH
+#endif
+
+NATIVEEARTH_KERNEL_DISPATCH
+void OscProbCalcerNativeEarth::ApplySegment(const NativeEarthHamiltonian& H, double Potential, double Length, const FLOAT_T* __restrict__ Energy, int nEnergy,
+                                            double (* __restrict__ AmpRe)[kEnergyBlockSize], double (* __restrict__ AmpIm)[kEnergyBlockSize], bool First) {
+  const double PiOver3 = M_PI/3.;
+  const double TwoSqrt3 = 2.*std::sqrt(3.);
+  const double Third = 1./3.;
+
+  #if UseMultithreading == 1
+  #pragma omp simd
+  #endif
+  for (int iEnergy=0;iEnergy<nEnergy;iEnergy++) {
+    const double E = Energy[iEnergy];
+    const double a = Potential*E;
+
+    // Hamiltonian and its square, upper triangle
+    const double h00 = H.M00+a;
+    const double q00 = H.Q00+a*(2*H.M00+a);
+    const double q01r = H.Q01r+a*H.M01r, q01i = H.Q01i+a*H.M01i;
+    const double q02r = H.Q02r+a*H.M02r, q02i = H.Q02i+a*H.M02i;
+
+    // Eigenvalues from the characteristic polynomial lambda^3 - A*lambda^2 + B*lambda - C
+    const double A = H.Trace+a;
+    const double B = H.Minors+a*H.See;
+    const double C = a*H.Tee;
+
+    const double A3 = A*Third;
+    const double p = B-A*A3;
+    const double q = A3*(B-2*A3*A3)-C;
+
+    const double r = std::sqrt(std::max(-p*Third,1e-30));
+    const double CosArg = std::min(1.,std::max(-1.,-q/(2*r*r*r)));
+    const double phi = std::acos(CosArg)*Third;
+
+    const double Dlambda21 = TwoSqrt3*r*std::sin(phi);
+    const double Dlambda32 = TwoSqrt3*r*std::sin(PiOver3-phi);
+    const double Dlambda31 = Dlambda32+Dlambda21;
+    const double x3 = 2*r*std::cos(phi);
+    const double x2 = x3-Dlambda32;
+    const double x1 = x2-Dlambda21;
+
+    // Sylvester's formula weights
+    const double w1 = 1/(Dlambda21*Dlambda31);
+    const double w2 = -1/(Dlambda21*Dlambda32);
+    const double w3 = 1/(Dlambda31*Dlambda32);
+
+    const double lambda1 = x1+A3, lambda2 = x2+A3, lambda3 = x3+A3;
+    const double f1 = A-lambda1, f2 = A-lambda2, f3 = A-lambda3;
+    const double g1 = B-lambda1*f1, g2 = B-lambda2*f2, g3 = B-lambda3*f3;
+
+    const double Tau = Length/E;
+    const double cos1 = std::cos(x1*Tau), sin1 = std::sin(x1*Tau);
+    const double cos2 = std::cos(x2*Tau), sin2 = std::sin(x2*Tau);
+    const double cos3 = std::cos(x3*Tau), sin3 = std::sin(x3*Tau);
+
+    // exp(-i*x_k*Tau) = cos_k - i*sin_k
+    const double c2r = cos1*w1+cos2*w2+cos3*w3;
+    const double c2i = -(sin1*w1+sin2*w2+sin3*w3);
+    const double c1r = -(cos1*w1*f1+cos2*w2*f2+cos3*w3*f3);
+    const double c1i = sin1*w1*f1+sin2*w2*f2+sin3*w3*f3;
+    const double c0r = cos1*w1*g1+cos2*w2*g2+cos3*w3*g3;
+    const double c0i = -(sin1*w1*g1+sin2*w2*g2+sin3*w3*g3);
+
+    // Diagonal elements, where H and H^2 are real
+    double Sr[9], Si[9];
+    Sr[0] = c2r*q00+c1r*h00+c0r;     Si[0] = c2i*q00+c1i*h00+c0i;
+    Sr[4] = c2r*H.Q11+c1r*H.M11+c0r; Si[4] = c2i*H.Q11+c1i*H.M11+c0i;
+    Sr[8] = c2r*H.Q22+c1r*H.M22+c0r; Si[8] = c2i*H.Q22+c1i*H.M22+c0i;
+
+    // Off-diagonal elements, S_ij = c2*Q_ij + c1*H_ij and S_ji = c2*conj(Q_ij) + c1*conj(H_ij)
+    Sr[1] = c2r*q01r-c2i*q01i+c1r*H.M01r-c1i*H.M01i; Si[1] = c2r*q01i+c2i*q01r+c1r*H.M01i+c1i*H.M01r;
+    Sr[3] = c2r*q01r+c2i*q01i+c1r*H.M01r+c1i*H.M01i; Si[3] = -c2r*q01i+c2i*q01r-c1r*H.M01i+c1i*H.M01r;
+    Sr[2] = c2r*q02r-c2i*q02i+c1r*H.M02r-c1i*H.M02i; Si[2] = c2r*q02i+c2i*q02r+c1r*H.M02i+c1i*H.M02r;
+    Sr[6] = c2r*q02r+c2i*q02i+c1r*H.M02r+c1i*H.M02i; Si[6] = -c2r*q02i+c2i*q02r-c1r*H.M02i+c1i*H.M02r;
+    Sr[5] = c2r*H.Q12r-c2i*H.Q12i+c1r*H.M12r-c1i*H.M12i; Si[5] = c2r*H.Q12i+c2i*H.Q12r+c1r*H.M12i+c1i*H.M12r;
+    Sr[7] = c2r*H.Q12r+c2i*H.Q12i+c1r*H.M12r+c1i*H.M12i; Si[7] = -c2r*H.Q12i+c2i*H.Q12r-c1r*H.M12i+c1i*H.M12r;
+
+    if (First) {
+      for (int i=0;i<9;i++) {
+        AmpRe[i][iEnergy] = Sr[i];
+        AmpIm[i][iEnergy] = Si[i];
+      }
+      continue;
+    }
+
+    // Amp = S*Amp
+    double NewRe[9], NewIm[9];
+    for (int iRow=0;iRow<3;iRow++) {
+      for (int iCol=0;iCol<3;iCol++) {
+        double Re = 0., Im = 0.;
+        for (int k=0;k<3;k++) {
+          Re += Sr[3*iRow+k]*AmpRe[3*k+iCol][iEnergy]-Si[3*iRow+k]*AmpIm[3*k+iCol][iEnergy];
+          Im += Sr[3*iRow+k]*AmpIm[3*k+iCol][iEnergy]+Si[3*iRow+k]*AmpRe[3*k+iCol][iEnergy];
+        }
+        NewRe[3*iRow+iCol] = Re;
+        NewIm[3*iRow+iCol] = Im;
+      }
+    }
+    for (int i=0;i<9;i++) {
+      AmpRe[i][iEnergy] = NewRe[i];
+      AmpIm[i][iEnergy] = NewIm[i];
+    }
+  }
+}
@@ -0,0 +1,167 @@
+#include "OscProbCalcer_NativeLinear.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#if UseMultithreading == 1
+#include "omp.h"
+#endif
+
+OscProbCalcerNativeLinear::OscProbCalcerNativeLinear(YAML::Node Config_) : OscProbCalcerBase(Config_)
+{
+  //=======
+  //Grab information from the config
+  UseSinglePrecisionKernel = (sizeof(FLOAT_T) == sizeof(float));
+  if (Config_["OscProbCalcerSetup"]["Precision"]) {
+    std::string Precision = Config_["OscProbCalcerSetup"]["Precision"].as<std::string>();
+    if (Precision == "Float" || Precision == "float") {
+      UseSinglePrecisionKernel = true;
+    } else if (Precision == "Double" || Precision == "double") {
+      UseSinglePrecisionKernel = false;
+    } else {
+      std::cerr << "Invalid Precision:" << Precision << " requested in " << fImplementationName << std::endl;
+      std::cerr << "Expected 'Float' or 'Double'" << std::endl;
+      throw std::runtime_error("Invalid setup");
+    }
+  }
+
+  //=======
+  std::vector<std::string> OscParNames = {"sin2_th12","sin2_th23","sin2_th13","dm2_12","dm2_23","delta_cp","path_length","matter_density","electron_density"};
+  SetExpectedParameterNames(OscParNames);
+  EnableDeltaCPCache(kDCP);
+
+  fNNeutrinoTypes = 2;
+  InitialiseNeutrinoTypesArray(fNNeutrinoTypes);
+  fNeutrinoTypes[0] = Nu;
+  fNeutrinoTypes[1] = Nubar;
+
+#if UseMultithreading == 1
+  fImplementationName += "-CPU-"+std::to_string(fNThreads);
+#else
+  fImplementationName += "-CPU-"+std::to_string(1);
+#endif
+
+  // This implementation only considers linear propagation, thus no requirement to set cosineZ array
+  IgnoreCosineZBinning(true);
+}
+
+OscProbCalcerNativeLinear::~OscProbCalcerNativeLinear() {
+
+}
+
+void OscProbCalcerNativeLinear::SetupPropagator() {
+  FlavourChannelIndex = std::vector<int>(9,-1);
+  for (int iOscChannel=fNOscillationChannels-1;iOscChannel>=0;iOscChannel--) {
+    const int gflv = fOscillationChannels[iOscChannel].GeneratedFlavour-1;
+    const int dflv = fOscillationChannels[iOscChannel].DetectedFlavour-1;
+    if (gflv < 0 || gflv > 2 || dflv < 0 || dflv > 2) {
+      std::cerr << "Invalid oscillation channel requested in " << fImplementationName << ":" << fOscillationChannels[iOscChannel].GeneratedFlavour << " -> " << fOscillationChannels[iOscChannel].DetectedFlavour << std::endl;
+      std::cerr << "Only the three active flavours are supported" << std::endl;
+      throw std::runtime_error("Invalid setup");
+    }
+    FlavourChannelIndex[3*gflv+dflv] = iOscChannel;
+  }
+}
+
+void OscProbCalcerNativeLinear::CalculateProbabilities() {
+  if (UseSinglePrecisionKernel) {
+    CalculateProbabilitiesWithPrecision<float>();
+  } else {
+    CalculateProbabilitiesWithPrecision<double>();
+  }
+}
+
+template <typename T>
+void OscProbCalcerNativeLinear::CalculateProbabilitiesWithPrecision() {
+  // ------------------------------- //
+  // Set the experimental parameters //
+  // ------------------------------- //
+  const double L = GetOscillationParameter(kPATHL); // km
+  const double rho = GetOscillationParameter(kDENS); // g/cc
+  const double Ye = GetOscillationParameter(kELECDENS);
+
+  // ------------------------------------- //
+  // Set the vacuum oscillation parameters //
+  // ------------------------------------- //
+  const double s12sq = GetOscillationParameter(kTH12);
+  const double s13sq = GetOscillationParameter(kTH13);
+  const double s23sq = GetOscillationParameter(kTH23);
+  const double delta = GetOscillationParameter(kDCP);
+  const double Dmsq21 = GetOscillationParameter(kDM12);
+
+  //Need to convert fOscParams[kDM23] to kDM31
+  const double Dmsq31 = GetOscillationParameter(kDM23)+GetOscillationParameter(kDM12); // eV^2
+
+  const double eVsqkm_to_GeV_over4 = 1e-9 / 1.97327e-7 * 1e3 / 4;
+  const double YerhoE2a = 1.52588e-4;
+
+  // ------------------------------------------------------------------ //
+  // Energy independent terms, evaluated in double precision once per   //
+  // reweight and then handed to the vectorised kernel                  //
+  // ------------------------------------------------------------------ //
+  const double c13sq = 1-s13sq;
+  const double Ue2sq = c13sq*s12sq;
+  const double Ue3sq = s13sq;
+  const double Um3sq = c13sq*s23sq;
+  const double Ut2sq = s13sq*s12sq*s23sq;
+  const double Um2sq_CPC = (1-s12sq)*(1-s23sq);
+  const double Jrr = sqrt(Um2sq_CPC*Ut2sq);
+  const double Um2sq = Um2sq_CPC+Ut2sq-2*Jrr*cos(delta);
+
+  NativeKernelInputs<T> Inputs;
+  Inputs.TraceVac = Dmsq21+Dmsq31;
+  Inputs.DetVac = Dmsq21*Dmsq31;
+  Inputs.See = Dmsq21+Dmsq31-Dmsq21*Ue2sq-Dmsq31*Ue3sq;
+  Inputs.Tee = Dmsq21*Dmsq31*(1-Ue3sq-Ue2sq);
+  Inputs.Hmm = Dmsq21*Um2sq+Dmsq31*Um3sq;
+  Inputs.Um1sq = 1-Um3sq-Um2sq;
+  Inputs.Jvac = 8*Jrr*c13sq*sin(delta)*Dmsq21*Dmsq31*(Dmsq31-Dmsq21);
+  Inputs.YerhoE = Ye*rho*YerhoE2a;
+  Inputs.LOver4 = eVsqkm_to_GeV_over4*L;
+
+  const int nEnergyBlocks = (fNEnergyPoints+kEnergyBlockSize-1)/kEnergyBlockSize;
+
+  #if UseMultithreading == 1
+  #pragma omp parallel for collapse(2)
+  #endif
+  for (int iBlock=0;iBlock<nEnergyBlocks;iBlock++) {
+    for (int iNuType=0;iNuType<fNNeutrinoTypes;iNuType++) {
+      const int BlockStart = iBlock*kEnergyBlockSize;
+      const int nBlockEnergies = std::min(kEnergyBlockSize,fNEnergyPoints-BlockStart);
+
+      // Requested channels are written straight into their slice of fWeightArray, the rest go to scratch
+      FLOAT_T Scratch[9][kEnergyBlockSize];
+      FLOAT_T* Probs[9];
+      for (int iFlav=0;iFlav<9;iFlav++) {
+        if (FlavourChannelIndex[iFlav] >= 0) {
+          Probs[iFlav] = &fWeightArray[ReturnWeightArrayIndex(iNuType,FlavourChannelIndex[iFlav],BlockStart)];
+        } else {
+          Probs[iFlav] = Scratch[iFlav];
+        }
+      }
+
+      NativeKernel(Inputs, &fEnergyArray[BlockStart], nBlockEnergies, T(fNeutrinoTypes[iNuType]), Probs);
+
+      // Only needed if the same channel has been requested more than once
+      for (int iOscChannel=0;iOscChannel<fNOscillationChannels;iOscChannel++) {
+        const int iFlav = 3*(fOscillationChannels[iOscChannel].GeneratedFlavour-1)+(fOscillationChannels[iOscChannel].DetectedFlavour-1);
+        if (FlavourChannelIndex[iFlav] != iOscChannel) {
+          std::copy(Probs[iFlav],Probs[iFlav]+nBlockEnergies,&fWeightArray[ReturnWeightArrayIndex(iNuType,iOscChannel,BlockStart)]);
+        }
+      }
+    }
+  }
+}
+
+int OscProbCalcerNativeLinear::ReturnWeightArrayIndex(int NuTypeIndex, int OscChanIndex, int EnergyIndex, int CosineZIndex) {
+  // Linear propagation has no cosine zenith dimension
+  (void)CosineZIndex;
+  int IndexToReturn = NuTypeIndex*fNOscillationChannels*fNEnergyPoints + OscChanIndex*fNEnergyPoints + EnergyIndex;
+  return IndexToReturn;
+}
+
+long OscProbCalcerNativeLinear::DefineWeightArraySize() {
+  long nCalculationPoints = static_cast<long>(fNEnergyPoints) * fNOscillationChannels * fNNeutrinoTypes;
+  return nCalculationPoints;
+}
@@ -0,0 +1,134 @@
+#ifndef __OSCILLATOR_NATIVELINEAR_H__
+#define __OSCILLATOR_NATIVELINEAR_H__
+
+#include "OscProbCalcerBase.h"
+#include "OscProbCalcer_LinearMatterKernel.h"
+
+/**
+ * @file OscProbCalcer_NativeLinear.h
+ *
+ * @class OscProbCalcerNativeLinear
+ *
+ * @brief Built-in oscillation calculation engine for three-flavour linear propagation through constant density matter.
+ *
+ * The matter Hamiltonian is diagonalised in closed form: the eigenvalues are the trigonometric (Cardano) roots of its characteristic polynomial and the
+ * mixing matrix elements in matter follow from the eigenvector-eigenvalue identity. The calculation is vectorised over blocks of energies and has no
+ * external dependency, so this engine is always available.
+ */
+class OscProbCalcerNativeLinear : public OscProbCalcerBase {
+ public:
+
+  /**
+   * @brief Default constructor
+   *
+   * @param Config_ YAML::Node to setup the OscProbCalcerNativeLinear() instance
+   */
+  OscProbCalcerNativeLinear(YAML::Node Config_);
+
+  /**
+   * @brief Constructor which takes a file path, creates a YAML::Node and calls the default constructor
+   *
+   * @param ConfigName_ File path to config
+   */
+  OscProbCalcerNativeLinear(std::string ConfigName_) : OscProbCalcerNativeLinear(YAML::LoadFile(ConfigName_)) {}
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~OscProbCalcerNativeLinear();
+
+  // ========================================================================================================================================================================
+  // Functions which need implementation specific code
+
+  /**
+   * @brief Setup NativeLinear specific variables
+   */
+  void SetupPropagator() override;
+
+  /**
+   * @brief Calculate some oscillation probabilities for a particular oscillation parameter set
+   *
+   * All nine probabilities are evaluated together for each block of energies, and the requested channels are written straight into #fWeightArray.
+   */
+  void CalculateProbabilities() override;
+
+  /**
+   * @brief Return implementation specific index in the weight array for a specific combination of neutrino oscillation channel, energy and cosine zenith
+   *
+   * @param NuTypeIndex The index in #fNeutrinoTypes (neutrino/antinuetrino) to return the pointer for
+   * @param OscChanIndex The index in #fOscillationChannels to return the pointer for
+   * @param EnergyIndex The index in #fEnergyArray to return the pointer for
+   * @param CosineZIndex The index in #fCosineZArray to return the pointer for
+   *
+   * @return Index in #fWeightArray which corresponds to the given inputs
+   */
+  int ReturnWeightArrayIndex(int NuTypeIndex, int OscNuIndex, int EnergyIndex, int CosineZIndex=-1) override;
+
+  /**
+   * @brief Define the size of fWeightArray
+   *
+   * @return Length that #fWeightArray should be initialised to
+   */
+  long DefineWeightArraySize() override;
+
+  // ========================================================================================================================================================================
+  // Functions which help setup implementation specific code
+
+  /**
+   * @brief Energy independent terms of the constant density Hamiltonian, evaluated in double precision once per reweight. The same terms feed the
+   * NuFAST kernel of OscProbCalcerNuFASTLinear
+   */
+  template <typename T>
+  using NativeKernelInputs = NuOscillator::LinearMatterTerms<T>;
+
+  /**
+   * @brief Evaluate all nine probabilities for a contiguous block of energies, in single or double precision following the type of In
+   *
+   * Defined in OscProbCalcer_NativeLinearKernel.cpp, the only file of this implementation built with -ffast-math
+   *
+   * @param In Energy independent terms
+   * @param Energy Array of nEnergy energies in GeV
+   * @param nEnergy Number of energies to evaluate, at most #kEnergyBlockSize
+   * @param Sign +1 for neutrinos, -1 for antineutrinos
+   * @param Probs Nine arrays of length nEnergy, stored as [3*GeneratedFlavour+DetectedFlavour] (zero-indexed)
+   */
+  static void NativeKernel(const NativeKernelInputs<float>& In, const FLOAT_T* __restrict__ Energy, int nEnergy, float Sign, FLOAT_T* const* Probs);
+  static void NativeKernel(const NativeKernelInputs<double>& In, const FLOAT_T* __restrict__ Energy, int nEnergy, double Sign, FLOAT_T* const* Probs);
+
+  /**
+   * @brief Evaluate every energy block for both neutrino types with the kernel instantiated for precision T
+   */
+  template <typename T>
+  void CalculateProbabilitiesWithPrecision();
+
+  // ========================================================================================================================================================================
+  // Variables which are needed for implementation specific code
+
+  /**
+   * @brief Definition of oscillation parameters which are expected in this implementation
+   */
+  enum OscParams{kTH12, kTH23, kTH13, kDM12, kDM23, kDCP, kPATHL, kDENS, kELECDENS, kNOscParams};
+
+  /**
+   * @brief Define the neutrino and antineutrino values expected by this implementation
+   */
+  enum NuType{Nu=1,Nubar=-1};
+
+  /**
+   * @brief Config option "Precision" which selects whether the kernel is evaluated in single ("Float") or double ("Double") precision. Defaults to FLOAT_T
+   */
+  bool UseSinglePrecisionKernel;
+
+  /**
+   * @brief Index in #fOscillationChannels of each (generated,detected) flavour pair, stored as [3*(GeneratedFlavour-1)+(DetectedFlavour-1)], or -1 if not requested
+   */
+  std::vector<int> FlavourChannelIndex;
+
+  /**
+   * @brief Number of energies evaluated by a single call to the vectorised kernel
+   */
+  static constexpr int kEnergyBlockSize = 256;
+
+};
+
+#endif
@@ -0,0 +1,93 @@
+#include "OscProbCalcer_NativeLinear.h"
+
+#include <cmath>
+
+#include "OscProbCalcer_LinearMatterKernel.h"
+
+// This file only holds the vectorised kernel, as it is built with -ffast-math (see OscProbCalcer/CMakeLists.txt) whilst the rest of the implementation is not
+
+// Build the vectorised kernel for AVX-512, AVX2 and baseline x86-64. The dynamic loader picks the best version for the CPU being used
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__CUDACC__) && defined(__x86_64__)
+#define NATIVE_KERNEL_DISPATCH __attribute__((target_clones("arch=skylake-avx512","arch=haswell","default")))
+#else
+#define NATIVE_KERNEL_DISPATCH
+#endif
+
+namespace {
+  /**
+   * @brief Evaluate all nine probabilities for a contiguous block of energies in precision T
+   *
+   * The eigenvalues of the matter Hamiltonian are the roots of lambda^3 - A*lambda^2 + B*lambda - C, found with the trigonometric form of Cardano's
+   * formula. The eigenvalue differences are taken from the same angle using sum-to-product identities so that the small solar splitting does not
+   * suffer from cancellation. Antineutrinos are evaluated with negative energies. The probabilities then follow from
+   * NuOscillator::LinearMatterProbabilitiesFromEigenvalues().
+   *
+   * @param In Energy independent terms
+   * @param Energy Array of nEnergy energies in GeV
+   * @param nEnergy Number of energies to evaluate, at most OscProbCalcerNativeLinear::kEnergyBlockSize
+   * @param Sign +1 for neutrinos, -1 for antineutrinos
+   * @param Probs Nine arrays of length nEnergy, stored as [3*GeneratedFlavour+DetectedFlavour] (zero-indexed)
+   */
+  template <typename T>
+  LINEAR_MATTER_KERNEL_INLINE void NativeKernelBody(const OscProbCalcerNativeLinear::NativeKernelInputs<T>& In, const FLOAT_T* __restrict__ Energy, int nEnergy, T Sign, FLOAT_T* const* Probs) {
+    FLOAT_T* __restrict__ Pee_ = Probs[0]; FLOAT_T* __restrict__ Pem_ = Probs[1]; FLOAT_T* __restrict__ Pet_ = Probs[2];
+    FLOAT_T* __restrict__ Pme_ = Probs[3]; FLOAT_T* __restrict__ Pmm_ = Probs[4]; FLOAT_T* __restrict__ Pmt_ = Probs[5];
+    FLOAT_T* __restrict__ Pte_ = Probs[6]; FLOAT_T* __restrict__ Ptm_ = Probs[7]; FLOAT_T* __restrict__ Ptt_ = Probs[8];
+
+    const T PiOver3 = T(M_PI/3.);
+    const T TwoSqrt3 = T(2.*std::sqrt(3.));
+    const T Third = T(1./3.);
+
+    #if UseMultithreading == 1
+    #pragma omp simd
+    #endif
+    for (int iEnergy=0;iEnergy<nEnergy;iEnergy++) {
+      const T E = Sign*T(Energy[iEnergy]);
+      const T Amatter = In.YerhoE*E;
+
+      // Coefficients of the characteristic polynomial
+      const T A = In.TraceVac+Amatter;
+      const T B = In.DetVac+Amatter*In.See;
+      const T C = Amatter*In.Tee;
+
+      // Depressed cubic x^3 + p*x + q = 0 with lambda = x + A/3
+      const T A3 = A*Third;
+      const T p = B-A*A3;
+      const T q = A3*(B-2*A3*A3)-C;
+
+      const T r = std::sqrt(std::fmax(-p*Third,T(1e-30)));
+      const T CosArg = std::fmin(T(1),std::fmax(T(-1),-q/(2*r*r*r)));
+      const T phi = std::acos(CosArg)*Third;
+
+      // Ordered eigenvalues lambda1 < lambda2 < lambda3
+      const T Dlambda21 = TwoSqrt3*r*std::sin(phi);
+      const T Dlambda32 = TwoSqrt3*r*std::sin(PiOver3-phi);
+      // lambda1+lambda2+lambda3 = A gives lambda3 without cos(phi), which GCC would otherwise merge with sin(phi) into a sincos call that has no vector form
+      const T lambda3 = A3+(2*Dlambda32+Dlambda21)*Third;
+      const T lambda2 = lambda3-Dlambda32;
+
+      // Mixing matrix in matter and probabilities, shared with the NuFAST kernel
+      const NuOscillator::LinearMatterProbabilities<T> P = NuOscillator::LinearMatterProbabilitiesFromEigenvalues<T>(In, E, lambda2, lambda3, Dlambda21, Dlambda32);
+      Pee_[iEnergy] = P.Pee;
+      Pem_[iEnergy] = P.Pem;
+      Pet_[iEnergy] = P.Pet;
+      Pme_[iEnergy] = P.Pme;
+      Pmm_[iEnergy] = P.Pmm;
+      Pmt_[iEnergy] = P.Pmt;
+      Pte_[iEnergy] = P.Pte;
+      Ptm_[iEnergy] = P.Ptm;
+      Ptt_[iEnergy] = P.Ptt;
+    }
+  }
+}
+
+// target_clones can not be attached to a template, so each precision gets its own dispatched entry point
+NATIVE_KERNEL_DISPATCH
+void OscProbCalcerNativeLinear::NativeKernel(const NativeKernelInputs<float>& In, const FLOAT_T* __restrict__ Energy, int nEnergy, float Sign, FLOAT_T* const* Probs) {
+  NativeKernelBody<float>(In, Energy, nEnergy, Sign, Probs);
+}
+
+NATIVE_KERNEL_DISPATCH
+void OscProbCalcerNativeLinear::NativeKernel(const NativeKernelInputs<double>& In, const FLOAT_T* __restrict__ Energy, int nEnergy, double Sign, FLOAT_T* const* Probs) {
+  NativeKernelBody<double>(In, Energy, nEnergy, Sign, Probs);
+}
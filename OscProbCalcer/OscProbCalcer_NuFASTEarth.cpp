@@ -2,6 +2,12 @@
 
 #include "Matrix.h"
 
+#include <algorithm>
+
+#if UseMultithreading == 1
+#include "omp.h"
+#endif
+
 OscProbCalcerNuFASTEarth::OscProbCalcerNuFASTEarth(YAML::Node Config_) : OscProbCalcerBase(Config_)
 { 
   //=======
@@ -30,35 +36,68 @@ OscProbCalcerNuFASTEarth::OscProbCalcerNuFASTEarth(YAML::Node Config_) : OscProb
   fNeutrinoTypes[0] = Nu;
   fNeutrinoTypes[1] = Nubar;
   
+  // A propagator is created for each of the fNThreads threads in SetupPropagator()
+  nThreads = 1;
+  fNThreadsFixedAtSetup = true;
+  fImplementationName += "-CPU-"+std::to_string(fNThreads);
+
   // This implementation only considers atmopsheric propagation, thus no requirement to set cosineZ array
   IgnoreCosineZBinning(false);
 }
 
 OscProbCalcerNuFASTEarth::~OscProbCalcerNuFASTEarth() {
-  if (EarthDensity) {delete EarthDensity;}
-  if (ProbEngine) {delete ProbEngine;}
+  for (size_t iEngine=0;iEngine<ProbEngines.size();iEngine++) {
+    delete ProbEngines[iEngine];
+    delete EarthDensities[iEngine];
+  }
 }
 
 void OscProbCalcerNuFASTEarth::SetupPropagator() {
+  nThreads = fNThreads;
+
   //=============================
-  //Set the Earth Model
-  if (EarthModel == "Prob3") {
-    EarthDensity = new NuFast::PREM_Prob3();
-  } else if (EarthModel == "PREM4") {
-    EarthDensity = new NuFast::PREM_Four();
-  } else if (EarthModel == "Full") {
-    EarthDensity = new NuFast::PREM_Full();
-  } else if (EarthModel == "NUniformLayers") {
-    EarthDensity = new NuFast::PREM_NUniformLayer(NUniformLayers);
-  } else {
-    std::cerr << "Did not find a valid EarthModel to build - given:" << EarthModel << std::endl;
-    throw std::runtime_error("Invalid Earth Model in NuFASTEarth");
+  //Split the CosineZ rows into one contiguous chunk per thread
+  nCosineZChunks = std::max(1,std::min(nThreads,fNCosineZPoints));
+  CosineZChunks.resize(nCosineZChunks);
+  CosineZChunkStart.resize(nCosineZChunks);
+  for (int iChunk=0;iChunk<nCosineZChunks;iChunk++) {
+    int ChunkBegin = (iChunk*fNCosineZPoints)/nCosineZChunks;
+    int ChunkEnd = ((iChunk+1)*fNCosineZPoints)/nCosineZChunks;
+    CosineZChunkStart[iChunk] = ChunkBegin;
+    CosineZChunks[iChunk] = std::vector<FLOAT_T>(fCosineZArray.begin()+ChunkBegin,fCosineZArray.begin()+ChunkEnd);
   }
   //=============================
 
-  ProbEngine = new NuFast::Probability_Engine();
-  ProbEngine->Set_Earth(DetectorDepth, EarthDensity);
-  ProbEngine->Set_Eigenvalue_Precision(EigenValuePrecision);
+  int nEngines = fNNeutrinoTypes*nCosineZChunks;
+  EarthDensities.resize(nEngines);
+  ProbEngines.resize(nEngines);
+  SpectraProductionHeights.resize(nEngines);
+  for (int iEngine=0;iEngine<nEngines;iEngine++) {
+    //=============================
+    //Set the Earth Model
+    if (EarthModel == "Prob3") {
+      EarthDensities[iEngine] = new NuFast::PREM_Prob3();
+    } else if (EarthModel == "PREM4") {
+      EarthDensities[iEngine] = new NuFast::PREM_Four();
+    } else if (EarthModel == "Full") {
+      EarthDensities[iEngine] = new NuFast::PREM_Full();
+    } else if (EarthModel == "NUniformLayers") {
+      EarthDensities[iEngine] = new NuFast::PREM_NUniformLayer(NUniformLayers);
+    } else {
+      std::cerr << "Did not find a valid EarthModel to build - given:" << EarthModel << std::endl;
+      throw std::runtime_error("Invalid Earth Model in NuFASTEarth");
+    }
+    //=============================
+
+    ProbEngines[iEngine] = new NuFast::Probability_Engine();
+    ProbEngines[iEngine]->Set_Earth(DetectorDepth, EarthDensities[iEngine]);
+    ProbEngines[iEngine]->Set_Eigenvalue_Precision(EigenValuePrecision);
+
+    //Spectra are built on the first call to CalculateProbabilities()
+    SpectraProductionHeights[iEngine] = DUMMYVAL;
+  }
+
+  if (fVerbose >= NuOscillator::INFO) {std::cout << "Using " << nEngines << " NuFAST-Earth engines (" << nCosineZChunks << " CosineZ chunks per neutrino type) with:" << nThreads << " threads" << std::endl;}
 }
 
 void OscProbCalcerNuFASTEarth::CalculateProbabilities() {
@@ -73,23 +112,48 @@ void OscProbCalcerNuFASTEarth::CalculateProbabilities() {
 
   const double ProductionHeight = GetOscillationParameter(kPROD); //km
 
-  for (int iNuType=0;iNuType<fNNeutrinoTypes;iNuType++) {
+  //Neutrinos and antineutrinos are evaluated in the same parallel region, each engine owning a disjoint set of CosineZ rows
+  const int nEngines = fNNeutrinoTypes*nCosineZChunks;
+  #if UseMultithreading == 1
+  #pragma omp parallel for schedule(static) num_threads(nThreads)
+  #endif
+  for (int iEngine=0;iEngine<nEngines;iEngine++) {
+    const int iNuType = iEngine/nCosineZChunks;
+    const int iChunk = iEngine%nCosineZChunks;
+    NuFast::Probability_Engine* ProbEngine = ProbEngines[iEngine];
 
     bool NeutrinoType = (fNeutrinoTypes[iNuType] == Nu) ? true : false;
     ProbEngine->Set_Oscillation_Parameters(s12sq, s13sq, s23sq, delta, Dmsq21, Dmsq31, NeutrinoType);
-    ProbEngine->Set_Production_Height(ProductionHeight);
-    ProbEngine->Set_Spectra(fEnergyArray, fCosineZArray);
-    std::vector<std::vector<NuFast::Matrix3r>> probabilities = ProbEngine->Get_Probabilities();
+
+    //The Energy and CosineZ arrays are fixed once setup, so the spectra only need rebuilding when the production height moves
+    if (ProductionHeight != SpectraProductionHeights[iEngine]) {
+      ProbEngine->Set_Production_Height(ProductionHeight);
+      ProbEngine->Set_Spectra(fEnergyArray, CosineZChunks[iChunk]);
+      SpectraProductionHeights[iEngine] = ProductionHeight;
+    }
+
+    const std::vector<std::vector<NuFast::Matrix3r>> probabilities = ProbEngine->Get_Probabilities();
+
+    //Walk the engine output once in (Energy,CosineZ) order, which is also the order of each channel's slice of fWeightArray
+    FLOAT_T* ChannelWeights[NuOscillator::nNeutrinoFlavours*NuOscillator::nNeutrinoFlavours];
+    int gflv[NuOscillator::nNeutrinoFlavours*NuOscillator::nNeutrinoFlavours];
+    int dflv[NuOscillator::nNeutrinoFlavours*NuOscillator::nNeutrinoFlavours];
     for (int iOscChannel = 0; iOscChannel < fNOscillationChannels; iOscChannel++) {
-      for (int iEnergyPoint=0;iEnergyPoint<fNEnergyPoints;iEnergyPoint++) {
-        for (int iCosineZPoint=0;iCosineZPoint<fNCosineZPoints;iCosineZPoint++) {
-          int Index = ReturnWeightArrayIndex(iNuType,iOscChannel,iEnergyPoint,iCosineZPoint);
-          const int gflv = fOscillationChannels[iOscChannel].GeneratedFlavour-1;
-          const int dflv = fOscillationChannels[iOscChannel].DetectedFlavour-1;
+      ChannelWeights[iOscChannel] = &fWeightArray[ReturnWeightArrayIndex(iNuType,iOscChannel,0,CosineZChunkStart[iChunk])];
+      gflv[iOscChannel] = fOscillationChannels[iOscChannel].GeneratedFlavour-1;
+      dflv[iOscChannel] = fOscillationChannels[iOscChannel].DetectedFlavour-1;
+    }
 
-          fWeightArray[Index] = probabilities[iEnergyPoint][iCosineZPoint].arr[gflv][dflv];
+    const int nChunkCosineZPoints = CosineZChunks[iChunk].size();
+    for (int iEnergyPoint=0;iEnergyPoint<fNEnergyPoints;iEnergyPoint++) {
+      const std::vector<NuFast::Matrix3r>& EnergyProbabilities = probabilities[iEnergyPoint];
+      for (int iCosineZPoint=0;iCosineZPoint<nChunkCosineZPoints;iCosineZPoint++) {
+        const NuFast::Matrix3r& Probability = EnergyProbabilities[iCosineZPoint];
+        const int Offset = iEnergyPoint*fNCosineZPoints + iCosineZPoint;
+        for (int iOscChannel = 0; iOscChannel < fNOscillationChannels; iOscChannel++) {
+          ChannelWeights[iOscChannel][Offset] = Probability.arr[gflv[iOscChannel]][dflv[iOscChannel]];
         }
-      } 
+      }
     }
   }
 }
@@ -88,14 +88,42 @@ class OscProbCalcerNuFASTEarth : public OscProbCalcerBase {
   enum NuType{Nu=1,Nubar=-1};
 
   /**
-   * @brief NuFAST Object that defines the Earth Model
+   * @brief NuFAST Objects that define the Earth Model, one per entry in #ProbEngines so that no state is shared between threads
    */
-  NuFast::Earth_Density* EarthDensity;
+  std::vector<NuFast::Earth_Density*> EarthDensities;
 
   /**
-   * @brief NuFAST Object which does the calculation
+   * @brief NuFAST Objects which do the calculation, one per (neutrino type, CosineZ chunk) pair
+   *
+   * Each engine only holds the CosineZ rows of its chunk, such that all engines can be evaluated concurrently. Keeping the engines alive means the spectra (and the
+   * Earth paths built from them) only need to be rebuilt when the production height changes
+   */
+  std::vector<NuFast::Probability_Engine*> ProbEngines;
+
+  /**
+   * @brief Production height (km) the spectra in each of #ProbEngines were last built with
+   */
+  std::vector<FLOAT_T> SpectraProductionHeights;
+
+  /**
+   * @brief CosineZ values evaluated by each chunk of #fCosineZArray
+   */
+  std::vector< std::vector<FLOAT_T> > CosineZChunks;
+
+  /**
+   * @brief Index in #fCosineZArray of the first CosineZ value of each chunk
+   */
+  std::vector<int> CosineZChunkStart;
+
+  /**
+   * @brief Number of chunks #fCosineZArray is split into
+   */
+  int nCosineZChunks;
+
+  /**
+   * @brief Number of threads used to evaluate the chunks
    */
-  NuFast::Probability_Engine* ProbEngine;
+  int nThreads;
 
   /**
    * @brief Config option that defines depth of detector in km
@@ -1,6 +1,8 @@
 #include "OscProbCalcer_NuFASTLinear.h"
 
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 
 #include "c++/NuFast.cpp"
 
@@ -23,10 +25,16 @@ OscProbCalcerNuFASTLinear::OscProbCalcerNuFASTLinear(YAML::Node Config_) : OscPr
   if (Config_["OscProbCalcerSetup"]["nNewtonIter"]) {
     N_Newton = Config_["OscProbCalcerSetup"]["nNewtonIter"].as<int>();
   }
+
+  UseSIMDKernel = true;
+  if (Config_["OscProbCalcerSetup"]["UseSIMDKernel"]) {
+    UseSIMDKernel = Config_["OscProbCalcerSetup"]["UseSIMDKernel"].as<bool>();
+  }
   
   //=======
   std::vector<std::string> OscParNames = {"sin2_th12","sin2_th23","sin2_th13","dm2_12","dm2_23","delta_cp","path_length","matter_density","electron_density"};
   SetExpectedParameterNames(OscParNames);
+  EnableDeltaCPCache(kDCP);
   
   fNNeutrinoTypes = 2;
   InitialiseNeutrinoTypesArray(fNNeutrinoTypes);
@@ -34,7 +42,7 @@ OscProbCalcerNuFASTLinear::OscProbCalcerNuFASTLinear(YAML::Node Config_) : OscPr
   fNeutrinoTypes[1] = Nubar;
   
 #if UseMultithreading == 1
-  fImplementationName += "-CPU-"+std::to_string(omp_get_max_threads());
+  fImplementationName += "-CPU-"+std::to_string(fNThreads);
 #else
   fImplementationName += "-CPU-"+std::to_string(1);
 #endif
@@ -48,6 +56,12 @@ OscProbCalcerNuFASTLinear::~OscProbCalcerNuFASTLinear() {
 }
 
 void OscProbCalcerNuFASTLinear::SetupPropagator() {
+  FlavourChannelIndex = std::vector<int>(9,-1);
+  for (int iOscChannel=fNOscillationChannels-1;iOscChannel>=0;iOscChannel--) {
+    const int gflv = fOscillationChannels[iOscChannel].GeneratedFlavour-1;
+    const int dflv = fOscillationChannels[iOscChannel].DetectedFlavour-1;
+    FlavourChannelIndex[3*gflv+dflv] = iOscChannel;
+  }
 }
 
 void OscProbCalcerNuFASTLinear::CalculateProbabilities() {
@@ -70,6 +84,71 @@ void OscProbCalcerNuFASTLinear::CalculateProbabilities() {
   //Need to convert fOscParams[kDM23] to kDM31
   const double Dmsq31 = GetOscillationParameter(kDM23)+GetOscillationParameter(kDM12); // eV^2
   
+  if (UseSIMDKernel) {
+    // ------------------------------------------------------------------ //
+    // Energy independent terms, evaluated in double precision once per   //
+    // reweight and then handed to the vectorised kernel                  //
+    // ------------------------------------------------------------------ //
+    const double eVsqkm_to_GeV_over4 = 1e-9 / 1.97327e-7 * 1e3 / 4;
+    const double YerhoE2a = 1.52588e-4;
+
+    const double c13sq = 1-s13sq;
+    const double Ut2sq = s13sq*s12sq*s23sq;
+    double Um2sq = (1-s12sq)*(1-s23sq);
+    const double Jrr = sqrt(Um2sq*Ut2sq);
+    Um2sq = Um2sq+Ut2sq-2*Jrr*cos(delta);
+
+    NuFASTKernelInputs Inputs;
+    Inputs.s13sq = s13sq;
+    Inputs.Dmsq31 = Dmsq31;
+    Inputs.Dmsqee = Dmsq31-s12sq*Dmsq21;
+    Inputs.N_Newton = N_Newton;
+    Inputs.TraceVac = Dmsq21+Dmsq31;
+    Inputs.DetVac = Dmsq21*Dmsq31;
+    Inputs.See = Dmsq21+Dmsq31-Dmsq21*c13sq*s12sq-Dmsq31*s13sq;
+    Inputs.Tee = Dmsq21*Dmsq31*(1-s13sq-c13sq*s12sq);
+    Inputs.Hmm = Dmsq21*Um2sq+Dmsq31*c13sq*s23sq;
+    Inputs.Um1sq = 1-c13sq*s23sq-Um2sq;
+    Inputs.Jvac = 8*Jrr*c13sq*sin(delta)*Dmsq21*Dmsq31*(Dmsq31-Dmsq21);
+    Inputs.YerhoE = Ye*rho*YerhoE2a;
+    Inputs.LOver4 = eVsqkm_to_GeV_over4*L;
+
+    const int nEnergyBlocks = (fNEnergyPoints+kEnergyBlockSize-1)/kEnergyBlockSize;
+
+    #if UseMultithreading == 1
+    #pragma omp parallel for collapse(2)
+    #endif
+    for (int iBlock=0;iBlock<nEnergyBlocks;iBlock++) {
+      for (int iNuType=0;iNuType<fNNeutrinoTypes;iNuType++) {
+        const int BlockStart = iBlock*kEnergyBlockSize;
+        const int nBlockEnergies = std::min(kEnergyBlockSize,fNEnergyPoints-BlockStart);
+
+        // Requested channels are written straight into their slice of fWeightArray, the rest go to scratch
+        FLOAT_T Scratch[9][kEnergyBlockSize];
+        FLOAT_T* Probs[9];
+        for (int iFlav=0;iFlav<9;iFlav++) {
+          if (FlavourChannelIndex[iFlav] >= 0) {
+            Probs[iFlav] = &fWeightArray[ReturnWeightArrayIndex(iNuType,FlavourChannelIndex[iFlav],BlockStart)];
+          } else {
+            Probs[iFlav] = Scratch[iFlav];
+          }
+        }
+
+        NuFASTKernel(Inputs, &fEnergyArray[BlockStart], nBlockEnergies, fNeutrinoTypes[iNuType], Probs);
+
+        // Only needed if the same channel has been requested more than once
+        for (int iOscChannel=0;iOscChannel<fNOscillationChannels;iOscChannel++) {
+          const int iFlav = 3*(fOscillationChannels[iOscChannel].GeneratedFlavour-1)+(fOscillationChannels[iOscChannel].DetectedFlavour-1);
+          if (FlavourChannelIndex[iFlav] != iOscChannel) {
+            std::copy(Probs[iFlav],Probs[iFlav]+nBlockEnergies,&fWeightArray[ReturnWeightArrayIndex(iNuType,iOscChannel,BlockStart)]);
+          }
+        }
+      }
+    }
+
+    return;
+  }
+
   double probs_returned[3][3];
   // ------------------------------------------ //
   // Calculate all 9 oscillations probabilities //
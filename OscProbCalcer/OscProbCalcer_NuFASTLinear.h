@@ -2,6 +2,7 @@
 #define __OSCILLATOR_NUFASTLINEAR_H__
 
 #include "OscProbCalcerBase.h"
+#include "OscProbCalcer_LinearMatterKernel.h"
 
 /**
  * @file OscProbCalcer_NuFASTLinear.h
@@ -72,6 +73,30 @@ class OscProbCalcerNuFASTLinear : public OscProbCalcerBase {
   // ========================================================================================================================================================================
   // Functions which help setup implementation specific code
 
+  /**
+   * @brief Energy independent terms of Probability_Matter_LBL(), evaluated once per reweight. The Hamiltonian terms are shared with OscProbCalcerNativeLinear,
+   * the remaining ones seed and refine lambda3
+   */
+  struct NuFASTKernelInputs : public NuOscillator::LinearMatterTerms<FLOAT_T> {
+    FLOAT_T s13sq, Dmsq31, Dmsqee;
+    int N_Newton;
+  };
+
+  /**
+   * @brief Evaluate all nine NuFAST probabilities for a contiguous block of energies
+   *
+   * This is the algorithm of Probability_Matter_LBL() written as a structure-of-arrays loop over energy so that it can be vectorised, with each of the nine outputs
+   * written to its own contiguous array. Once lambda3 is refined, the probabilities follow from NuOscillator::LinearMatterProbabilitiesFromEigenvalues(). Antineutrinos
+   * are evaluated with negative energies, as in NuFAST. Defined in OscProbCalcer_NuFASTLinearKernel.cpp, the only file of this implementation built with -ffast-math
+   *
+   * @param In Energy independent terms
+   * @param Energy Array of nEnergy energies in GeV
+   * @param nEnergy Number of energies to evaluate, at most #kEnergyBlockSize
+   * @param Sign +1 for neutrinos, -1 for antineutrinos
+   * @param Probs Nine arrays of length nEnergy, stored as [3*GeneratedFlavour+DetectedFlavour] (zero-indexed)
+   */
+  static void NuFASTKernel(const NuFASTKernelInputs& In, const FLOAT_T* __restrict__ Energy, int nEnergy, FLOAT_T Sign, FLOAT_T* const* Probs);
+
   // ========================================================================================================================================================================
   // Variables which are needed for implementation specific code
 
@@ -89,6 +114,21 @@ class OscProbCalcerNuFASTLinear : public OscProbCalcerBase {
    * @brief Define the number of newton iterations used within calculation
    */
   int N_Newton;
+
+  /**
+   * @brief Config option which selects the vectorised kernel (default) or the scalar NuFAST Probability_Matter_LBL() call for each energy
+   */
+  bool UseSIMDKernel;
+
+  /**
+   * @brief Index in #fOscillationChannels of each (generated,detected) flavour pair, stored as [3*(GeneratedFlavour-1)+(DetectedFlavour-1)], or -1 if not requested
+   */
+  std::vector<int> FlavourChannelIndex;
+
+  /**
+   * @brief Number of energies evaluated by a single call to the vectorised kernel
+   */
+  static constexpr int kEnergyBlockSize = 256;
   
 };
 
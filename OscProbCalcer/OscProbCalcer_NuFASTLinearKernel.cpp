@@ -0,0 +1,80 @@
+#include "OscProbCalcer_NuFASTLinear.h"
+
+#include <cmath>
+
+#include "OscProbCalcer_LinearMatterKernel.h"
+
+// This file only holds the vectorised kernel, as it is built with -ffast-math (see OscProbCalcer/CMakeLists.txt) whilst the rest of the implementation is not
+
+// Build the vectorised kernel for AVX-512, AVX2 and baseline x86-64. The dynamic loader picks the best version for the CPU being used
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__CUDACC__) && defined(__x86_64__)
+#define NUFAST_KERNEL_DISPATCH __attribute__((target_clones("arch=skylake-avx512","arch=haswell","default")))
+#else
+#define NUFAST_KERNEL_DISPATCH
+#endif
+
+NUFAST_KERNEL_DISPATCH
+void OscProbCalcerNuFASTLinear::NuFASTKernel(const NuFASTKernelInputs& In, const FLOAT_T* __restrict__ Energy, int nEnergy, FLOAT_T Sign, FLOAT_T* const* Probs) {
+  FLOAT_T* __restrict__ Pee_ = Probs[0]; FLOAT_T* __restrict__ Pem_ = Probs[1]; FLOAT_T* __restrict__ Pet_ = Probs[2];
+  FLOAT_T* __restrict__ Pme_ = Probs[3]; FLOAT_T* __restrict__ Pmm_ = Probs[4]; FLOAT_T* __restrict__ Pmt_ = Probs[5];
+  FLOAT_T* __restrict__ Pte_ = Probs[6]; FLOAT_T* __restrict__ Ptm_ = Probs[7]; FLOAT_T* __restrict__ Ptt_ = Probs[8];
+
+  // The Newton iterations are done as separate passes over the block so that every loop body is branch free and can be vectorised
+  FLOAT_T Lambda3[kEnergyBlockSize];
+
+  // Get lambda3 from lambda+ of MP/DMP
+  #if UseMultithreading == 1
+  #pragma omp simd
+  #endif
+  for (int iEnergy=0;iEnergy<nEnergy;iEnergy++) {
+    const FLOAT_T Amatter = In.YerhoE*Sign*Energy[iEnergy];
+    const FLOAT_T xmat = Amatter/In.Dmsqee;
+    const FLOAT_T tmp = 1-xmat;
+    Lambda3[iEnergy] = In.Dmsq31+FLOAT_T(0.5)*In.Dmsqee*(xmat-1+std::sqrt(tmp*tmp+4*In.s13sq*xmat));
+  }
+
+  // Newton iterations to improve lambda3
+  for (int iNewton=0;iNewton<In.N_Newton;iNewton++) {
+    #if UseMultithreading == 1
+    #pragma omp simd
+    #endif
+    for (int iEnergy=0;iEnergy<nEnergy;iEnergy++) {
+      const FLOAT_T Amatter = In.YerhoE*Sign*Energy[iEnergy];
+      const FLOAT_T A = In.TraceVac+Amatter;
+      const FLOAT_T B = In.DetVac+Amatter*In.See;
+      const FLOAT_T C = Amatter*In.Tee;
+      const FLOAT_T lambda3 = Lambda3[iEnergy];
+      Lambda3[iEnergy] = (lambda3*lambda3*(lambda3+lambda3-A)+C)/(lambda3*(2*(lambda3-A)+lambda3)+B);
+    }
+  }
+
+  #if UseMultithreading == 1
+  #pragma omp simd
+  #endif
+  for (int iEnergy=0;iEnergy<nEnergy;iEnergy++) {
+    const FLOAT_T E = Sign*Energy[iEnergy];
+
+    const FLOAT_T Amatter = In.YerhoE*E;
+    const FLOAT_T C = Amatter*In.Tee;
+    const FLOAT_T A = In.TraceVac+Amatter;
+    const FLOAT_T lambda3 = Lambda3[iEnergy];
+
+    // Get Delta lambda's
+    const FLOAT_T tmp = A-lambda3;
+    const FLOAT_T Dlambda21 = std::sqrt(tmp*tmp-4*C/lambda3);
+    const FLOAT_T lambda2 = FLOAT_T(0.5)*(A-lambda3+Dlambda21);
+    const FLOAT_T Dlambda32 = lambda3-lambda2;
+
+    // Mixing matrix in matter and probabilities, shared with the NativeLinear kernel
+    const NuOscillator::LinearMatterProbabilities<FLOAT_T> P = NuOscillator::LinearMatterProbabilitiesFromEigenvalues<FLOAT_T>(In, E, lambda2, lambda3, Dlambda21, Dlambda32);
+    Pee_[iEnergy] = P.Pee;
+    Pem_[iEnergy] = P.Pem;
+    Pet_[iEnergy] = P.Pet;
+    Pme_[iEnergy] = P.Pme;
+    Pmm_[iEnergy] = P.Pmm;
+    Pmt_[iEnergy] = P.Pmt;
+    Pte_[iEnergy] = P.Pte;
+    Ptm_[iEnergy] = P.Ptm;
+    Ptt_[iEnergy] = P.Ptt;
+  }
+}
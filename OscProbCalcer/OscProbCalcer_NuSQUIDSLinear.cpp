@@ -1,15 +1,28 @@
 #include "OscProbCalcer_NuSQUIDSLinear.h"
 
 #include <iostream>
+#include <algorithm>
+
+#if UseMultithreading == 1
+#include "omp.h"
+#endif
 
 OscProbCalcerNuSQUIDSLinear::OscProbCalcerNuSQUIDSLinear(YAML::Node Config_) : OscProbCalcerBase(Config_)
 {
-  nus_base = nullptr;
-  nubars_base = nullptr;
+  NuSQUIDSObjects = std::vector<nusquids::nuSQUIDS*>();
+
+  Body = nullptr;
+  BodyDensity = DUMMYVAL;
+  BodyElectronFraction = DUMMYVAL;
+  TrackLength = DUMMYVAL;
 
   //=======
   //Grab information from the config
 
+  //Threads - Each (neutrino type, initial flavour) evolution is independent so can be evolved on its own thread. 'OscProbCalcerSetup''Threads' is read by OscProbCalcerBase
+  nThreads = 1;
+  fNThreadsFixedAtSetup = true;
+
   //IntegrationStep
   if (!Config_["OscProbCalcerSetup"]["IntegrationStep"]) {
     std::cerr << "Expected to find a 'IntegrationStep' Node within the 'OscProbCalcerSetup''Implementation' Node" << std::endl;
@@ -31,6 +44,14 @@ OscProbCalcerNuSQUIDSLinear::OscProbCalcerNuSQUIDSLinear(YAML::Node Config_) : O
   }
   abs_error = Config_["OscProbCalcerSetup"]["AbsoluteError"].as<double>();
 
+  //Stepper - The GSL stepping function used to integrate the evolution. The embedded methods (rkf45, rkck, rk8pd) adapt their step size to
+  //satisfy RelativeError and AbsoluteError, with IntegrationStep as the maximum step size
+  fStepperName = "rk4";
+  if (Config_["OscProbCalcerSetup"]["Stepper"]) {
+    fStepperName = Config_["OscProbCalcerSetup"]["Stepper"].as<std::string>();
+  }
+  fGSLStepper = GSLStepper_StrToType(fStepperName);
+
   if (!Config_["OscProbCalcerSetup"]["NumNeutrinoFlavours"]) {
     std::cerr << "Expected to find a 'NumNeutrinoFlavours' Node within the 'OscProbCalcerSetup''Implementation' Node" << std::endl;
     throw std::runtime_error("YAML node not found");
@@ -65,8 +86,38 @@ OscProbCalcerNuSQUIDSLinear::OscProbCalcerNuSQUIDSLinear(YAML::Node Config_) : O
     }
     nsi_mutau_coupling = Config_["OscProbCalcerSetup"]["NSIMuTauCoupling"].as<FLOAT_T>();
   }
+
+  //EvolutionMode
+  fEvolutionMode = kPerFlavour;
+  if (Config_["OscProbCalcerSetup"]["EvolutionMode"]) {
+    std::string EvolutionMode = Config_["OscProbCalcerSetup"]["EvolutionMode"].as<std::string>();
+    if (EvolutionMode == "PerFlavour") {
+      fEvolutionMode = kPerFlavour;
+    } else if (EvolutionMode == "Unitarity") {
+      fEvolutionMode = kUnitarity;
+    } else {
+      std::cerr << "Unknown 'EvolutionMode' provided:" << EvolutionMode << " - Expected 'PerFlavour' or 'Unitarity'" << std::endl;
+      throw std::runtime_error("Invalid setup");
+    }
+  }
+
+  //Interactions - Neutral and charged current interactions along the track, passed as iinteraction to each nuSQUIDS object
+  fInteractions = true;
+  if (Config_["OscProbCalcerSetup"]["Interactions"]) {
+    fInteractions = Config_["OscProbCalcerSetup"]["Interactions"].as<bool>();
+  }
+
+  if (fEvolutionMode == kUnitarity && fOscModel == kDecoherence) {
+    std::cerr << "'EvolutionMode':'Unitarity' requires unitary evolution which is not the case for the Decoherence OscModel" << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  if (fEvolutionMode == kUnitarity && fInteractions) {
+    std::cerr << "'EvolutionMode':'Unitarity' requires unitary evolution which is not the case with interactions - Set 'Interactions':false or use 'PerFlavour'" << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
   //=======
   SetOscParams(fOscModel);
+  InitialiseEvolvedFlavours();
   
   fNNeutrinoTypes = 2;
   InitialiseNeutrinoTypesArray(fNNeutrinoTypes);
@@ -78,8 +129,9 @@ OscProbCalcerNuSQUIDSLinear::OscProbCalcerNuSQUIDSLinear(YAML::Node Config_) : O
 }
 
 OscProbCalcerNuSQUIDSLinear::~OscProbCalcerNuSQUIDSLinear() {
-  if(nus_base != nullptr) delete nus_base;
-  if(nubars_base != nullptr) delete nubars_base;
+  for (size_t iObject=0;iObject<NuSQUIDSObjects.size();iObject++) {
+    delete NuSQUIDSObjects[iObject];
+  }
 }
 
 void OscProbCalcerNuSQUIDSLinear::SetupPropagator() {
@@ -89,50 +141,6 @@ void OscProbCalcerNuSQUIDSLinear::SetupPropagator() {
     E_range[i] = fEnergyArray[i]*units.GeV;
   }
 
-  switch (fOscModel) {
-  case kSM:
-    nus_base = new nusquids::nuSQUIDS(E_range, nNeutrinoFlavours, nusquids::neutrino, true); // neutrinos
-    nubars_base = new nusquids::nuSQUIDS(E_range, nNeutrinoFlavours, nusquids::antineutrino, true); // antineutrinos
-    
-    break;
-
-  case kDecoherence:
-    nus_base = new nusquids::nuSQUIDSDecoh(E_range, nNeutrinoFlavours, nusquids::neutrino, true);
-    nubars_base = new nusquids::nuSQUIDSDecoh(E_range, nNeutrinoFlavours, nusquids::antineutrino, true);
-    
-    break;
-
-  case kLIV:
-    nus_base = new nusquids::nuSQUIDSLV(E_range, nNeutrinoFlavours, nusquids::neutrino, true);
-    nubars_base = new nusquids::nuSQUIDSLV(E_range, nNeutrinoFlavours, nusquids::antineutrino, true);
-
-    break;
-
-  case kNSI:
-    nus_base = new nuSQUIDSNSI(nsi_mutau_coupling, E_range, nNeutrinoFlavours, nusquids::neutrino, true);
-    nubars_base = new nuSQUIDSNSI(nsi_mutau_coupling, E_range, nNeutrinoFlavours, nusquids::antineutrino, true);
-
-    break;
-    
-  default:
-    std::cerr << "Unknown fOscModel provided:" << fOscModel << std::endl;
-    throw std::runtime_error("Invalid OscMode");
-  }
-  
-  //Set integration step
-  nus_base->Set_h_max(integration_step*units.km);
-  nubars_base->Set_h_max(integration_step*units.km);
-
-  //We set the GSL step function
-  nus_base->Set_GSL_step(gsl_odeiv2_step_rk4);
-  nubars_base->Set_GSL_step(gsl_odeiv2_step_rk4);
-
-  //Setting the numerical precision of gsl integrator.
-  nus_base->Set_rel_error(rel_error);
-  nus_base->Set_abs_error(abs_error);
-  nubars_base->Set_rel_error(rel_error);
-  nubars_base->Set_abs_error(abs_error);
-
   switch (fOscModel) {
   case kDecoherence:
     if (decoherence_model == "RandomizePhase") {
@@ -147,85 +155,133 @@ void OscProbCalcerNuSQUIDSLinear::SetupPropagator() {
     }
     break;
   }
-  
+
+  // One object per neutrino type and evolved initial flavour, so each of the evolutions owns its state and can be run concurrently
+  const int nEvolvedFlavours = static_cast<int>(EvolvedFlavours.size());
+  NuSQUIDSObjects = std::vector<nusquids::nuSQUIDS*>(fNNeutrinoTypes*nEvolvedFlavours,nullptr);
+  EvolvedProbabilities = std::vector< std::vector<double> >(NuSQUIDSObjects.size(),std::vector<double>(nNeutrinoFlavours*fNEnergyPoints,0.));
+  for (int iNuType=0;iNuType<fNNeutrinoTypes;iNuType++) {
+    nusquids::NeutrinoType NeutrinoType = (fNeutrinoTypes[iNuType] == Nubar) ? nusquids::antineutrino : nusquids::neutrino;
+
+    for (int iEvolvedFlavour=0;iEvolvedFlavour<nEvolvedFlavours;iEvolvedFlavour++) {
+      nusquids::nuSQUIDS* NuSQUIDSObject = CreateNuSQUIDSObject(E_range,NeutrinoType);
+
+      //Set integration step
+      NuSQUIDSObject->Set_h_max(integration_step*units.km);
+
+      //We set the GSL step function
+      NuSQUIDSObject->Set_GSL_step(fGSLStepper);
+
+      //Setting the numerical precision of gsl integrator.
+      NuSQUIDSObject->Set_rel_error(rel_error);
+      NuSQUIDSObject->Set_abs_error(abs_error);
+
+      NuSQUIDSObjects[iNuType*nEvolvedFlavours+iEvolvedFlavour] = NuSQUIDSObject;
+    }
+  }
+
+  nThreads = std::max(1,std::min(fNThreads,static_cast<int>(NuSQUIDSObjects.size())));
+  fNThreads = nThreads;
+  fImplementationName += "-CPU-"+std::to_string(nThreads);
+
+  Tracks = std::vector< std::shared_ptr<nusquids::ConstantDensity::Track> >(NuSQUIDSObjects.size(),nullptr);
+
+  if (fVerbose >= NuOscillator::INFO) {std::cout << "Setup " << NuSQUIDSObjects.size() << " NuSQUIDS objects evolved with the " << fStepperName << " stepper and:" << nThreads << " threads" << std::endl;}
 }
 
-void OscProbCalcerNuSQUIDSLinear::CalculateProbabilities() {
+nusquids::nuSQUIDS* OscProbCalcerNuSQUIDSLinear::CreateNuSQUIDSObject(const nusquids::marray<double,1>& E_range, nusquids::NeutrinoType NeutrinoType) {
+  switch (fOscModel) {
+  case kSM:
+    return new nusquids::nuSQUIDS(E_range, nNeutrinoFlavours, NeutrinoType, fInteractions);
+  case kDecoherence:
+    return new nusquids::nuSQUIDSDecoh(E_range, nNeutrinoFlavours, NeutrinoType, fInteractions);
+  case kLIV:
+    return new nusquids::nuSQUIDSLV(E_range, nNeutrinoFlavours, NeutrinoType, fInteractions);
+  case kNSI:
+    return new nuSQUIDSNSI(nsi_mutau_coupling, E_range, nNeutrinoFlavours, NeutrinoType, fInteractions);
+  default:
+    std::cerr << "Unknown fOscModel provided:" << fOscModel << std::endl;
+    throw std::runtime_error("Invalid OscMode");
+  }
+  return nullptr;
+}
 
-  // Set mixing angles and masses for neutrinos
-  nus_base->Set_MixingAngle(0,1,asin(sqrt(GetOscillationParameter(kTH12)))); // \theta_12
-  nus_base->Set_MixingAngle(0,2,asin(sqrt(GetOscillationParameter(kTH13)))); // \theta_13
-  nus_base->Set_MixingAngle(1,2,asin(sqrt(GetOscillationParameter(kTH23)))); // \theta_23
-  nus_base->Set_SquareMassDifference(1,GetOscillationParameter(kDM12)); // \Delta m_12
-  nus_base->Set_SquareMassDifference(2,GetOscillationParameter(kDM12) + GetOscillationParameter(kDM23)); // \Delta m_13
-  nus_base->Set_CPPhase(0,2,GetOscillationParameter(kDCP));
-
-  // Set mixing angles and masses for anti-neutrinos
-  nubars_base->Set_MixingAngle(0,1,asin(sqrt(GetOscillationParameter(kTH12)))); // \theta_12
-  nubars_base->Set_MixingAngle(0,2,asin(sqrt(GetOscillationParameter(kTH13)))); // \theta_13
-  nubars_base->Set_MixingAngle(1,2,asin(sqrt(GetOscillationParameter(kTH23)))); // \theta_23
-  nubars_base->Set_SquareMassDifference(1,GetOscillationParameter(kDM12)); // \Delta m_12
-  nubars_base->Set_SquareMassDifference(2,GetOscillationParameter(kDM12) + GetOscillationParameter(kDM23)); // \Delta m_13
-  nubars_base->Set_CPPhase(0,2,GetOscillationParameter(kDCP));
+void OscProbCalcerNuSQUIDSLinear::SetNuSQUIDSParameters(nusquids::nuSQUIDS* NuSQUIDSObject) {
+
+  // Set mixing angles and masses
+  NuSQUIDSObject->Set_MixingAngle(0,1,asin(sqrt(GetOscillationParameter(kTH12)))); // \theta_12
+  NuSQUIDSObject->Set_MixingAngle(0,2,asin(sqrt(GetOscillationParameter(kTH13)))); // \theta_13
+  NuSQUIDSObject->Set_MixingAngle(1,2,asin(sqrt(GetOscillationParameter(kTH23)))); // \theta_23
+  NuSQUIDSObject->Set_SquareMassDifference(1,GetOscillationParameter(kDM12)); // \Delta m_12
+  NuSQUIDSObject->Set_SquareMassDifference(2,GetOscillationParameter(kDM12) + GetOscillationParameter(kDM23)); // \Delta m_13
+  NuSQUIDSObject->Set_CPPhase(0,2,GetOscillationParameter(kDCP));
 
-  const double layer_2 = GetOscillationParameter(kPATHL)*units.km;
-  std::shared_ptr<nusquids::ConstantDensity> constdens_env1 = std::make_shared<nusquids::ConstantDensity>(GetOscillationParameter(kDENS),GetOscillationParameter(kELECDENS)); // density [gr/cm^3[, ye [dimensionless]
-  std::shared_ptr<nusquids::ConstantDensity::Track> track_env1 = std::make_shared<nusquids::ConstantDensity::Track>(layer_2);
-
-  // Set energy density for neutrinos
-  nus_base->Set_Body(constdens_env1);
-  nus_base->Set_Track(track_env1);
-
-  // Set energy density for anti-neutrinos
-  nubars_base->Set_Body(constdens_env1);
-  nubars_base->Set_Track(track_env1);
-
-  // Construct the initial state
-  // E_range is an array that contains all the energies.
-  nusquids::marray<double,1> E_range = nus_base->GetERange();
-  // Array that contains the initial state of the system, fist component is energy and second every one of the flavors
-  nusquids::marray<double,2> inistate{E_range.size(),static_cast<size_t>(nNeutrinoFlavours)};
-  
   switch (fOscModel) {
   case kDecoherence: {
-    auto* nus_decoh = static_cast<nusquids::nuSQUIDSDecoh*>(nus_base);
-    auto* nubars_decoh = static_cast<nusquids::nuSQUIDSDecoh*>(nubars_base);
-
-    //Set the decoherence model and parameters for neutrinos
-    nus_decoh->Set_DecoherenceGammaMatrix(nusquids_decoherence_model, GetOscillationParameter(kEnergyStrength)*units.eV);
-    nus_decoh->Set_DecoherenceGammaEnergyDependence(GetOscillationParameter(kEnergyDep));
-    nus_decoh->Set_DecoherenceGammaEnergyScale(GetOscillationParameter(kEnergyScale)*units.GeV);
-    
-    //Set the decoherence model and parameters for anti-neutrinos
-    nubars_decoh->Set_DecoherenceGammaMatrix(nusquids_decoherence_model, GetOscillationParameter(kEnergyStrength)*units.eV);
-    nubars_decoh->Set_DecoherenceGammaEnergyDependence(GetOscillationParameter(kEnergyDep));
-    nubars_decoh->Set_DecoherenceGammaEnergyScale(GetOscillationParameter(kEnergyScale)*units.GeV);
+    auto* NuSQUIDSObject_Decoh = static_cast<nusquids::nuSQUIDSDecoh*>(NuSQUIDSObject);
+
+    //Set the decoherence model and parameters
+    NuSQUIDSObject_Decoh->Set_DecoherenceGammaMatrix(nusquids_decoherence_model, GetOscillationParameter(kEnergyStrength)*units.eV);
+    NuSQUIDSObject_Decoh->Set_DecoherenceGammaEnergyDependence(GetOscillationParameter(kEnergyDep));
+    NuSQUIDSObject_Decoh->Set_DecoherenceGammaEnergyScale(GetOscillationParameter(kEnergyScale)*units.GeV);
     break;
   }
   case kLIV: {
     gsl_complex c_EMu{GetOscillationParameter(kEMuReal)*units.GeV, GetOscillationParameter(kEMuImg)*units.GeV};
     gsl_complex c_MuTau{GetOscillationParameter(kMuTauReal)*units.GeV, GetOscillationParameter(kMuTauImg)*units.GeV};
     LVParameters LIVPars{c_EMu,c_MuTau};
-    auto* nus_LIV = static_cast<nusquids::nuSQUIDSLV*>(nus_base);
-    auto* nubars_LIV = static_cast<nusquids::nuSQUIDSLV*>(nubars_base);
-    
-    nus_LIV->Set_LV_OpMatrix(LIVPars);
-    nus_LIV->Set_LV_EnergyPower(GetOscillationParameter(kEnergyPower));
-    
-    nubars_LIV->Set_LV_OpMatrix(LIVPars);
-    nubars_LIV->Set_LV_EnergyPower(GetOscillationParameter(kEnergyPower));
+    auto* NuSQUIDSObject_LIV = static_cast<nusquids::nuSQUIDSLV*>(NuSQUIDSObject);
+
+    NuSQUIDSObject_LIV->Set_LV_OpMatrix(LIVPars);
+    NuSQUIDSObject_LIV->Set_LV_EnergyPower(GetOscillationParameter(kEnergyPower));
     break;
   }
   }
-  
-  // Index counter to have a handle on where neutrino oscillation probs are stored in array fWeightArray
-  int index_counter = 0;
-
-  // Loop over all neutrino flavors, set the initial state, propagate the neutrinos and store osc probs in fWeightarray in
-  // order nu_e->nu_e,nu_e->nu_mu, nu_e->nu_tau,
-  //       nu_mu->nu_e, nu_mu->nu_mu, nu_mu->nu_tau,
-  //       nu_tau->nu_e, nu_tau->nu_mu, nu_tau->nu_tau,
-  for(int nu_flavor = 0; nu_flavor < nNeutrinoFlavours; nu_flavor++){
+}
+
+void OscProbCalcerNuSQUIDSLinear::CalculateProbabilities() {
+
+  const int nObjects = static_cast<int>(NuSQUIDSObjects.size());
+
+  // Only rebuild the body and tracks when the parameters which define them have changed
+  const double Density = GetOscillationParameter(kDENS);
+  const double ElectronFraction = GetOscillationParameter(kELECDENS);
+  if (Body == nullptr || Density != BodyDensity || ElectronFraction != BodyElectronFraction) {
+    Body = std::make_shared<nusquids::ConstantDensity>(Density,ElectronFraction); // density [gr/cm^3[, ye [dimensionless]
+    BodyDensity = Density;
+    BodyElectronFraction = ElectronFraction;
+  }
+
+  const double layer_2 = GetOscillationParameter(kPATHL)*units.km;
+  if (layer_2 != TrackLength) {
+    for (int iObject=0;iObject<nObjects;iObject++) {
+      Tracks[iObject] = std::make_shared<nusquids::ConstantDensity::Track>(layer_2);
+    }
+    TrackLength = layer_2;
+  }
+  const int nEvolvedFlavours = static_cast<int>(EvolvedFlavours.size());
+
+  // Each object is evolved from a single pure flavour initial state and the probabilities for every detected flavour are stored in EvolvedProbabilities
+#if UseMultithreading == 1
+  #pragma omp parallel for schedule(dynamic,1) num_threads(nThreads)
+#endif
+  for (int iObject=0;iObject<nObjects;iObject++) {
+    nusquids::nuSQUIDS* NuSQUIDSObject = NuSQUIDSObjects[iObject];
+    const int nu_flavor = EvolvedFlavours[iObject % nEvolvedFlavours];
+
+    SetNuSQUIDSParameters(NuSQUIDSObject);
+
+    // The track position is updated during the evolution so each object has its own, which is rewound to the start of the path before re-use
+    Tracks[iObject]->SetX(Tracks[iObject]->GetInitialX());
+    NuSQUIDSObject->Set_Body(Body);
+    NuSQUIDSObject->Set_Track(Tracks[iObject]);
+
+    // Construct the initial state
+    // E_range is an array that contains all the energies.
+    nusquids::marray<double,1> E_range = NuSQUIDSObject->GetERange();
+    // Array that contains the initial state of the system, fist component is energy and second every one of the flavors
+    nusquids::marray<double,2> inistate{E_range.size(),static_cast<size_t>(nNeutrinoFlavours)};
+
     // Set initial state for the electron neutrinos (k==0), muon neutrinos (k==1) and tau neutrinos (k==2), other flavors to 0.0
     for ( int i = 0 ; i < inistate.extent(0); i++){
       for ( int k = 0; k < inistate.extent(1); k ++){
@@ -236,60 +292,110 @@ void OscProbCalcerNuSQUIDSLinear::CalculateProbabilities() {
     switch (fOscModel) {
     case kLIV:
       //Set the initial state in nuSQuIDS object
-      static_cast<nusquids::nuSQUIDSLV*>(nus_base)->Set_initial_state(inistate,nusquids::flavor);
+      static_cast<nusquids::nuSQUIDSLV*>(NuSQUIDSObject)->Set_initial_state(inistate,nusquids::flavor);
       break;
     default:
       //Set the initial state in nuSQuIDS object
-      nus_base->Set_initial_state(inistate,nusquids::flavor);
+      NuSQUIDSObject->Set_initial_state(inistate,nusquids::flavor);
     }
-    
+
     //Propagate the neutrinos in the earth for the path defined in path
-    nus_base->EvolveState();
-    
+    NuSQUIDSObject->EvolveState();
+
     // Number of energies we want the result, notice that this can be larger than the number of the internal grid of 
     //the nuSQuIDS object, a linear interpolation between the quantum density matrices in the interaction picture is used
     //and vacuum oscillations are solved analytically for the given energy.
+    std::vector<double>& ObjectProbabilities = EvolvedProbabilities[iObject];
     for(int fl=0; fl<nNeutrinoFlavours; fl++){
       for(int i = 0; i < fNEnergyPoints; i++) {
-        fWeightArray[index_counter] = nus_base->EvalFlavor(fl, fEnergyArray[i]*units.GeV);
-        index_counter++;
+        ObjectProbabilities[fl*fNEnergyPoints+i] = NuSQUIDSObject->EvalFlavor(fl, fEnergyArray[i]*units.GeV);
       }
     }
   }
 
-  // Now the same for anti-neutrinos:
-  for(int nu_flavor = 0; nu_flavor < nNeutrinoFlavours; nu_flavor++){
-
-    // Set initial state for the electron neutrinos (k==0), muon neutrinos (k==1) and tau neutrinos (k==2), other flavors to 0.0
-    for ( int i = 0 ; i < inistate.extent(0); i++){
-      for ( int k = 0; k < inistate.extent(1); k ++){
-        inistate[i][k] = (k == nu_flavor) ? 1.0 : 0.0;
+  // Only the channels requested in the OscChannelMapping are copied into fWeightArray
+  for (int iNuType=0;iNuType<fNNeutrinoTypes;iNuType++) {
+    for (int iOscChannel=0;iOscChannel<fNOscillationChannels;iOscChannel++) {
+      const int GeneratedFlavour = fOscillationChannels[iOscChannel].GeneratedFlavour-1;
+      const int DetectedFlavour = fOscillationChannels[iOscChannel].DetectedFlavour-1;
+      FLOAT_T* Probs = &fWeightArray[ReturnWeightArrayIndex(iNuType,iOscChannel,0)];
+
+      if (GeneratedFlavour == ReconstructedFlavour) {
+        // Unitarity: P(x->b) = 1 - sum_{a!=x} P(a->b)
+        for (int i=0;i<fNEnergyPoints;i++) {
+          Probs[i] = 1.0;
+        }
+        for (int iEvolvedFlavour=0;iEvolvedFlavour<nEvolvedFlavours;iEvolvedFlavour++) {
+          const double* ObjectProbabilities = &EvolvedProbabilities[iNuType*nEvolvedFlavours+iEvolvedFlavour][DetectedFlavour*fNEnergyPoints];
+          for (int i=0;i<fNEnergyPoints;i++) {
+            Probs[i] -= ObjectProbabilities[i];
+          }
+        }
+      } else {
+        const int iEvolvedFlavour = static_cast<int>(std::find(EvolvedFlavours.begin(),EvolvedFlavours.end(),GeneratedFlavour)-EvolvedFlavours.begin());
+        const double* ObjectProbabilities = &EvolvedProbabilities[iNuType*nEvolvedFlavours+iEvolvedFlavour][DetectedFlavour*fNEnergyPoints];
+        for (int i=0;i<fNEnergyPoints;i++) {
+          Probs[i] = ObjectProbabilities[i];
+        }
       }
     }
+  }
 
-    switch (fOscModel) {
-    case kLIV:
-      //Set the initial state in nuSQuIDS object
-      static_cast<nusquids::nuSQUIDSLV*>(nubars_base)->Set_initial_state(inistate,nusquids::flavor);
-      break;
-    default:
-      //Set the initial state in nuSQuIDS object
-      nubars_base->Set_initial_state(inistate,nusquids::flavor);
+}
+
+void OscProbCalcerNuSQUIDSLinear::InitialiseEvolvedFlavours() {
+  std::vector<bool> FlavourRequested(nNeutrinoFlavours,false);
+  for (int iOscChannel=0;iOscChannel<fNOscillationChannels;iOscChannel++) {
+    const int GeneratedFlavour = fOscillationChannels[iOscChannel].GeneratedFlavour;
+    const int DetectedFlavour = fOscillationChannels[iOscChannel].DetectedFlavour;
+    if (GeneratedFlavour > nNeutrinoFlavours || DetectedFlavour > nNeutrinoFlavours) {
+      std::cerr << "OscChannelMapping entry " << iOscChannel << " (" << GeneratedFlavour << " -> " << DetectedFlavour << ") is not available with NumNeutrinoFlavours:" << nNeutrinoFlavours << std::endl;
+      throw std::runtime_error("Invalid setup");
     }
-    //Propagate the neutrinos in the earth for the path defined in path
-    nubars_base->EvolveState();
-    
-    // Number of energies we want the result, notice that this can be larger than the number of the internal grid of 
-    //the nuSQuIDS object, a linear interpolation between the quantum density matrices in the interaction picture is used
-    //and vacuum oscillations are solved analytically for the given energy.
-    for(int fl=0; fl < nNeutrinoFlavours; fl++){
-      for(int i = 0; i < fNEnergyPoints; i++) {
-        fWeightArray[index_counter] = nubars_base->EvalFlavor(fl, fEnergyArray[i]*units.GeV);
-        index_counter++;
-      }
+    FlavourRequested[GeneratedFlavour-1] = true;
+  }
+
+  EvolvedFlavours.clear();
+  for (int iFlavour=0;iFlavour<nNeutrinoFlavours;iFlavour++) {
+    if (FlavourRequested[iFlavour]) {
+      EvolvedFlavours.push_back(iFlavour);
     }
   }
-  
+
+  // Reconstructing a flavour through unitarity needs every other flavour to have been evolved
+  ReconstructedFlavour = -1;
+  if (fEvolutionMode == kUnitarity && static_cast<int>(EvolvedFlavours.size()) == nNeutrinoFlavours) {
+    ReconstructedFlavour = EvolvedFlavours.back();
+    EvolvedFlavours.pop_back();
+  }
+
+  if (fVerbose >= NuOscillator::INFO) {
+    std::cout << "NuSQUIDS will evolve " << EvolvedFlavours.size() << " initial flavours per neutrino type";
+    if (ReconstructedFlavour != -1) {std::cout << " and reconstruct initial flavour " << ReconstructedFlavour << " through unitarity";}
+    std::cout << std::endl;
+  }
+}
+
+const gsl_odeiv2_step_type* OscProbCalcerNuSQUIDSLinear::GSLStepper_StrToType(const std::string& Stepper) {
+  if (Stepper=="rk2") {
+    return gsl_odeiv2_step_rk2;
+  }
+  if (Stepper=="rk4") {
+    return gsl_odeiv2_step_rk4;
+  }
+  if (Stepper=="rkf45") {
+    return gsl_odeiv2_step_rkf45;
+  }
+  if (Stepper=="rkck") {
+    return gsl_odeiv2_step_rkck;
+  }
+  if (Stepper=="rk8pd") {
+    return gsl_odeiv2_step_rk8pd;
+  }
+
+  std::cerr << "Unknown Stepper string provided:" << Stepper << " - Expected one of rk2, rk4, rkf45, rkck, rk8pd" << std::endl;
+  throw std::runtime_error("Invalid Stepper");
+  return nullptr;
 }
 
 int OscProbCalcerNuSQUIDSLinear::PMNS_StrToInt(const std::string& OscModel) {
@@ -113,6 +113,37 @@ class OscProbCalcerNuSQUIDSLinear : public OscProbCalcerBase {
    * @param OscType int value corresponding to type of PMNS matrix
    */
   void SetOscParams(int OscType);
+
+  /**
+   * @brief Return the GSL stepping function corresponding to a particular string
+   *
+   * @param Stepper String to convert (rk2, rk4, rkf45, rkck or rk8pd)
+   *
+   * @return GSL stepping function used by the NuSQUIDS integrator
+   */
+  const gsl_odeiv2_step_type* GSLStepper_StrToType(const std::string& Stepper);
+
+  /**
+   * @brief Construct a NuSQUIDS object of the configured #fOscModel for either neutrinos or anti-neutrinos
+   *
+   * @param E_range Energy nodes (in natural units) of the NuSQUIDS object
+   * @param NeutrinoType Whether the object should propagate neutrinos or anti-neutrinos
+   *
+   * @return Pointer to the newly allocated NuSQUIDS object
+   */
+  nusquids::nuSQUIDS* CreateNuSQUIDSObject(const nusquids::marray<double,1>& E_range, nusquids::NeutrinoType NeutrinoType);
+
+  /**
+   * @brief Set the current oscillation parameters and the model specific parameters in a NuSQUIDS object
+   *
+   * @param NuSQUIDSObject Object to update
+   */
+  void SetNuSQUIDSParameters(nusquids::nuSQUIDS* NuSQUIDSObject);
+
+  /**
+   * @brief Determine which initial flavours need to be evolved (and which can be reconstructed) to fill the requested #fOscillationChannels
+   */
+  void InitialiseEvolvedFlavours();
  
   /**
    * @brief Set enums corresponding to BSM model 
@@ -139,14 +170,47 @@ class OscProbCalcerNuSQUIDSLinear : public OscProbCalcerBase {
   squids::Const units;
   
   /**
-   * @brief Declaration of the NuSQUIDS base class object for neutrinos
+   * @brief Enum to define how the probabilities for the requested oscillation channels are obtained from the NuSQUIDS evolutions
+   *
+   * kPerFlavour evolves a pure initial state for every generated flavour in the OscChannelMapping. kUnitarity only applies to models with unitary evolution, where
+   * the last generated flavour is reconstructed from the others (P(x->b) = 1 - sum_a P(a->b)) when all flavours are requested, saving one evolution per neutrino type.
+   */
+  enum EvolutionModes{kPerFlavour=0, kUnitarity=1};
+
+  /**
+   * @brief The EvolutionModes value requested in the config
+   */
+  int fEvolutionMode;
+
+  /**
+   * @brief Whether interactions along the track are included, which makes the evolution non-unitary. Set by 'Interactions', true by default
    */
-  nusquids::nuSQUIDS* nus_base;
+  bool fInteractions;
 
   /**
-   * @brief Declaration of the NuSQUIDS base class object for anti-neutrinos
+   * @brief The (zero-indexed) initial flavours which are evolved for each neutrino type, built from the generated flavours in #fOscillationChannels
    */
-  nusquids::nuSQUIDS* nubars_base;
+  std::vector<int> EvolvedFlavours;
+
+  /**
+   * @brief The (zero-indexed) initial flavour which is reconstructed through unitarity rather than evolved. -1 if all requested flavours are evolved
+   */
+  int ReconstructedFlavour;
+
+  /**
+   * @brief NuSQUIDS objects, one per neutrino type and evolved initial flavour (index iNuType*EvolvedFlavours.size()+iEvolvedFlavour), such that all evolutions can run concurrently
+   */
+  std::vector<nusquids::nuSQUIDS*> NuSQUIDSObjects;
+
+  /**
+   * @brief Detected flavour probabilities of each object in #NuSQUIDSObjects, stored as [iObject][DetectedFlavour*fNEnergyPoints+iEnergy]
+   */
+  std::vector< std::vector<double> > EvolvedProbabilities;
+
+  /**
+   * @brief The number of threads used to evolve the NuSQUIDS objects
+   */
+  int nThreads;
 
   /**
    * @brief Declaration of the string to choose the decoherence model
@@ -178,6 +242,41 @@ class OscProbCalcerNuSQUIDSLinear : public OscProbCalcerBase {
    */
   double abs_error;
 
+  /**
+   * @brief Name of the GSL stepping function requested in the config
+   */
+  std::string fStepperName;
+
+  /**
+   * @brief GSL stepping function used by the NuSQUIDS integrator
+   */
+  const gsl_odeiv2_step_type* fGSLStepper;
+
+  /**
+   * @brief Constant density body shared by all of the NuSQUIDS objects, rebuilt only when the density or electron fraction changes
+   */
+  std::shared_ptr<nusquids::ConstantDensity> Body;
+
+  /**
+   * @brief Tracks used by each of the NuSQUIDS objects, rebuilt only when the path length changes
+   */
+  std::vector< std::shared_ptr<nusquids::ConstantDensity::Track> > Tracks;
+
+  /**
+   * @brief Density used to build #Body
+   */
+  double BodyDensity;
+
+  /**
+   * @brief Electron fraction used to build #Body
+   */
+  double BodyElectronFraction;
+
+  /**
+   * @brief Path length (in natural units) used to build #Tracks
+   */
+  double TrackLength;
+
   /**
    * @brief Number of neutrino flavours considered in the analysis
    */
@@ -1,5 +1,11 @@
 #include "OscProbCalcer_OscLibLinear.h"
 
+#include <algorithm>
+
+#if UseMultithreading == 1
+#include "omp.h"
+#endif
+
 OscProbCalcerOscLibLinear::OscProbCalcerOscLibLinear(YAML::Node Config_) : OscProbCalcerBase(Config_) {
   //=======
   if (!Config_["OscProbCalcerSetup"]["PMNSType"]) {
@@ -18,21 +24,56 @@ OscProbCalcerOscLibLinear::OscProbCalcerOscLibLinear(YAML::Node Config_) : OscPr
   
   // This implementation only considers linear propagation, thus no requirement to set cosineZ array
   IgnoreCosineZBinning(true);
+
+  OscLibs = std::vector<osc::_IOscCalcAdjustable<FLOAT_T>*>();
+
+  // A propagator is created for each of the fNThreads threads in SetupPropagator()
+  nThreads = 1;
+  fNThreadsFixedAtSetup = true;
 }
 
 OscProbCalcerOscLibLinear::~OscProbCalcerOscLibLinear() {
-  if (OscLib) {delete OscLib;}
+  for (size_t iThread=0;iThread<OscLibs.size();iThread++) {
+    delete OscLibs[iThread];
+  }
 }
 
 void OscProbCalcerOscLibLinear::SetupPropagator() {
+  nThreads = fNThreads;
+  OscLibs = std::vector<osc::_IOscCalcAdjustable<FLOAT_T>*>(nThreads,nullptr);
+  for (int iThread=0;iThread<nThreads;iThread++) {
+    OscLibs[iThread] = CreateOscLib();
+  }
+  fImplementationName += "-CPU-"+std::to_string(nThreads);
+
+  // Check the channel mapping is representable before it is used within the threaded loop
+  for (int iOscChannel=0;iOscChannel<fNOscillationChannels;iOscChannel++) {
+    GetFlavour(fOscillationChannels[iOscChannel].GeneratedFlavour, Nu);
+    GetFlavour(fOscillationChannels[iOscChannel].DetectedFlavour, Nu);
+  }
+
+  // OscLib caches the propagation from the last (energy, neutrino type, generated flavour), so evaluate the channels grouped by generated flavour
+  OscChannelOrder = std::vector<int>(fNOscillationChannels);
+  for (int iOscChannel=0;iOscChannel<fNOscillationChannels;iOscChannel++) {
+    OscChannelOrder[iOscChannel] = iOscChannel;
+  }
+  std::stable_sort(OscChannelOrder.begin(),OscChannelOrder.end(),[this](int a, int b) {
+    return fOscillationChannels[a].GeneratedFlavour < fOscillationChannels[b].GeneratedFlavour;
+  });
+
+  if (fVerbose >= NuOscillator::INFO) {std::cout << "Setup OscLibLinear with:" << nThreads << " threads" << std::endl;}
+}
+
+osc::_IOscCalcAdjustable<FLOAT_T>* OscProbCalcerOscLibLinear::CreateOscLib() {
   if(fOscType == kPMNS) {
-    OscLib = new osc::_OscCalcPMNS<FLOAT_T>();
+    return new osc::_OscCalcPMNS<FLOAT_T>();
   } else if(fOscType == kNSI) {
-    OscLib = new osc::OscCalcPMNS_NSI();
-  } else {
-    std::cerr << "Invalid PMNS matrix type provided: " << fOscType << std::endl;
-    throw std::runtime_error("Invalid setup");
+    return new osc::OscCalcPMNS_NSI();
   }
+
+  std::cerr << "Invalid PMNS matrix type provided: " << fOscType << std::endl;
+  throw std::runtime_error("Invalid setup");
+  return nullptr;
 }
 
 int OscProbCalcerOscLibLinear::PMNS_StrToInt(const std::string& PMNSType) {
@@ -72,6 +113,36 @@ void OscProbCalcerOscLibLinear::CalculateProbabilities() {
     }
   }
 
+  // Configure each of the per-thread calculators once for this step
+  for (size_t iThread=0;iThread<OscLibs.size();iThread++) {
+    ConfigureOscLib(OscLibs[iThread]);
+  }
+
+#if UseMultithreading == 1
+  #pragma omp parallel for collapse(2) schedule(static) num_threads(nThreads)
+#endif
+  for (int iNuType=0;iNuType<fNNeutrinoTypes;iNuType++) {
+    for (int iOscProb=0;iOscProb<fNEnergyPoints;iOscProb++) {
+      int iThread = 0;
+#if UseMultithreading == 1
+      iThread = omp_get_thread_num();
+#endif
+      osc::_IOscCalcAdjustable<FLOAT_T>* OscLib = OscLibs[iThread];
+      FLOAT_T Energy = fEnergyArray[iOscProb];
+
+      for (int iChannel=0;iChannel<fNOscillationChannels;iChannel++) {
+        const int iOscChannel = OscChannelOrder[iChannel];
+        int GenFlav = GetFlavour(fOscillationChannels[iOscChannel].GeneratedFlavour, fNeutrinoTypes[iNuType]);
+        int DetFlav = GetFlavour(fOscillationChannels[iOscChannel].DetectedFlavour, fNeutrinoTypes[iNuType]);
+
+        int IndexToFill = iNuType*fNOscillationChannels*fNEnergyPoints + iOscChannel*fNEnergyPoints + iOscProb;
+        fWeightArray[IndexToFill] = OscLib->P(GenFlav,DetFlav,Energy);
+      }
+    }
+  }
+}
+
+void OscProbCalcerOscLibLinear::ConfigureOscLib(osc::_IOscCalcAdjustable<FLOAT_T>* OscLib) {
   const FLOAT_T theta12 = std::asin(std::sqrt(GetOscillationParameter(kTH12)));
   const FLOAT_T theta23 = std::asin(std::sqrt(GetOscillationParameter(kTH23)));
   const FLOAT_T theta13 = std::asin(std::sqrt(GetOscillationParameter(kTH13)));
@@ -102,20 +173,6 @@ void OscProbCalcerOscLibLinear::CalculateProbabilities() {
     OscLib_NSI->SetDelta_etau(GetOscillationParameter(kDelta_etau));
     OscLib_NSI->SetDelta_mutau(GetOscillationParameter(kDelta_mutau));
   }
-  for (int iNuType=0;iNuType<fNNeutrinoTypes;iNuType++) {
-    for (int iOscChannel=0;iOscChannel<fNOscillationChannels;iOscChannel++) {
-      
-      int IndexToFill = iNuType*fNOscillationChannels*fNEnergyPoints + iOscChannel*fNEnergyPoints;
-
-      for (int iOscProb=0;iOscProb<fNEnergyPoints;iOscProb++) {
-        FLOAT_T Energy = fEnergyArray[iOscProb];
-        int GenFlav = GetFlavour(fOscillationChannels[iOscChannel].GeneratedFlavour, fNeutrinoTypes[iNuType]);
-        int DetFlav = GetFlavour(fOscillationChannels[iOscChannel].DetectedFlavour, fNeutrinoTypes[iNuType]);
-
-        fWeightArray[IndexToFill+iOscProb] = OscLib->P(GenFlav,DetFlav,Energy);
-      }
-    }
-  }
 }
 
 int OscProbCalcerOscLibLinear::ReturnWeightArrayIndex(int NuTypeIndex, int OscChanIndex, int EnergyIndex, int CosineZIndex) {
@@ -93,6 +93,20 @@ class OscProbCalcerOscLibLinear : public OscProbCalcerBase {
    */
   void SetOscParams();
 
+  /**
+   * @brief Create a new OscLib calculator of the type defined by #fOscType
+   *
+   * @return Pointer to the newly allocated calculator
+   */
+  osc::_IOscCalcAdjustable<FLOAT_T>* CreateOscLib();
+
+  /**
+   * @brief Set the current oscillation parameters in an OscLib calculator
+   *
+   * @param OscLib Calculator to configure
+   */
+  void ConfigureOscLib(osc::_IOscCalcAdjustable<FLOAT_T>* OscLib);
+
   // ========================================================================================================================================================================
   // Variables which are needed for implementation specific code
   
@@ -121,9 +135,19 @@ class OscProbCalcerOscLibLinear : public OscProbCalcerBase {
   enum PMNSMatrix{kPMNS, kNSI};
 
   /**
-   * @brief OscLib object used to calculate the oscillation probabilities
+   * @brief OscLib objects used to calculate the oscillation probabilities, one per thread
+   */
+  std::vector<osc::_IOscCalcAdjustable<FLOAT_T>*> OscLibs;
+
+  /**
+   * @brief Indices of #fOscillationChannels ordered by generated flavour, such that OscLib's cached propagation from a given flavour is reused for every detected flavour
+   */
+  std::vector<int> OscChannelOrder;
+
+  /**
+   * @brief The number of threads being used to perform the calculation
    */
-  osc::_IOscCalcAdjustable<FLOAT_T>* OscLib;
+  int nThreads;
 
   /**
    * @brief Define the type for the PMNS matrix
@@ -11,7 +11,7 @@
 #include "inc/PMNS_LIV.h"
 #include "inc/PMNS_OQS.h"
 
-OscProbCalcerOscProb::OscProbCalcerOscProb(YAML::Node Config_) : OscProbCalcerBase(Config_), fPMNSObj(nullptr) {
+OscProbCalcerOscProb::OscProbCalcerOscProb(YAML::Node Config_) : OscProbCalcerBase(Config_), fPMNSObj(nullptr), fProbMatrixFiller(nullptr) {
   //=======
   //Grab information from the config
   if (!Config_["OscProbCalcerSetup"]["PMNSType"]) {
@@ -97,22 +97,28 @@ void OscProbCalcerOscProb::SetupPropagator() {
 
   if(fPMNSObj) delete fPMNSObj;
   fPMNSObj = GetPMNSObj();
+
+  fProbMatrixFiller = dynamic_cast<OscProbMatrixFiller*>(fPMNSObj);
+  if (!fProbMatrixFiller) {
+    std::cerr << "PMNS object returned by GetPMNSObj() does not implement OscProbMatrixFiller" << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
 }
 
 OscProb::PMNS_Base* OscProbCalcerOscProb::GetPMNSObj() {
- if(fOscType==kPMNSSterile1) return new OscProb::PMNS_Sterile(4);
- if(fOscType==kPMNSSterile2) return new OscProb::PMNS_Sterile(5);
- if(fOscType==kPMNSSterile3) return new OscProb::PMNS_Sterile(6);
- if(fOscType==kDecay)        return new OscProb::PMNS_Decay();
- if(fOscType==kDeco)         return new OscProb::PMNS_Deco();
- if(fOscType==kNSI)          return new OscProb::PMNS_NSI();
- if(fOscType==kSNSI)         return new OscProb::PMNS_SNSI();
- if(fOscType==kIter)         return new OscProb::PMNS_Iter();
- if(fOscType==kNUNM)         return new OscProb::PMNS_NUNM();
- if(fOscType==kLIV)          return new OscProb::PMNS_LIV();
- if(fOscType==kOQS)          return new OscProb::PMNS_OQS();
-
- return new OscProb::PMNS_Fast();
+ if(fOscType==kPMNSSterile1) return new OscProbPMNS<OscProb::PMNS_Sterile>(4);
+ if(fOscType==kPMNSSterile2) return new OscProbPMNS<OscProb::PMNS_Sterile>(5);
+ if(fOscType==kPMNSSterile3) return new OscProbPMNS<OscProb::PMNS_Sterile>(6);
+ if(fOscType==kDecay)        return new OscProbPMNS<OscProb::PMNS_Decay>();
+ if(fOscType==kDeco)         return new OscProbPMNS<OscProb::PMNS_Deco,OscProb::matrixC>();
+ if(fOscType==kNSI)          return new OscProbPMNS<OscProb::PMNS_NSI>();
+ if(fOscType==kSNSI)         return new OscProbPMNS<OscProb::PMNS_SNSI>();
+ if(fOscType==kIter)         return new OscProbPMNS<OscProb::PMNS_Iter>();
+ if(fOscType==kNUNM)         return new OscProbPMNS<OscProb::PMNS_NUNM>();
+ if(fOscType==kLIV)          return new OscProbPMNS<OscProb::PMNS_LIV>();
+ if(fOscType==kOQS)          return new OscProbPMNS<OscProb::PMNS_OQS,OscProb::matrixC>();
+
+ return new OscProbPMNS<OscProb::PMNS_Fast>();
 }
 
 void OscProbCalcerOscProb::CalculateProbabilities() {
@@ -141,7 +147,7 @@ void OscProbCalcerOscProb::CalcProbPMNS() {
       SetPath(iCosineZ);
 
       for (int iEnergy = 0; iEnergy < fNEnergyPoints; iEnergy++) {
-        OscProb::matrixD probMatrix = fPMNSObj->ProbMatrix(fMaxGenFlavour, fMaxDetFlavour, fEnergyArray[iEnergy]);
+        fProbMatrixFiller->FillProbMatrix(fMaxGenFlavour, fMaxDetFlavour, fEnergyArray[iEnergy], fProbMatrix);
 
         #if UseMultithreading == 1
         #pragma omp simd
@@ -150,7 +156,7 @@ void OscProbCalcerOscProb::CalcProbPMNS() {
 
           const int gflv = fOscillationChannels[iOscChannel].GeneratedFlavour-1;
           const int dflv = fOscillationChannels[iOscChannel].DetectedFlavour-1;
-          const double weight = probMatrix[gflv][dflv];
+          const double weight = fProbMatrix[gflv*fMaxDetFlavour+dflv];
           const int index = ReturnWeightArrayIndex(iNuType, iOscChannel, iEnergy, iCosineZ);
 
           fWeightArray[index] = weight;
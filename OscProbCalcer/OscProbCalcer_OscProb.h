@@ -9,6 +9,86 @@
 /**
  * @file OscProbCalcer_OscProb.h
  *
+ * @brief OscProbCalcerOscProb, together with the OscProbPMNS wrapper which fills the OscProb probability matrix into a fixed buffer
+ */
+
+/**
+ * @brief Interface used to fill a probability matrix into a caller-provided buffer
+ *
+ * OscProb::PMNS_Base::ProbMatrix() returns a freshly allocated OscProb::matrixD for every call. This interface exposes an alternative which
+ * writes straight into a fixed-size buffer owned by the caller, such that no heap allocation happens within the energy loop.
+ */
+class OscProbMatrixFiller {
+ public:
+  /**
+   * @brief Destructor
+   */
+  virtual ~OscProbMatrixFiller() {}
+
+  /**
+   * @brief Fill the probability matrix for the current path and a given energy
+   *
+   * @param nflvi Number of initial flavours to evaluate
+   * @param nflvf Number of final flavours to evaluate
+   * @param Energy Neutrino energy in GeV
+   * @param Probs Buffer of length (nflvi*nflvf), filled such that Probs[flvi*nflvf+flvf] = P(flvi->flvf)
+   */
+  virtual void FillProbMatrix(int nflvi, int nflvf, double Energy, double* Probs) = 0;
+};
+
+/**
+ * @brief Thin wrapper around any OscProb PMNS class which implements OscProbMatrixFiller
+ *
+ * Follows OscProb::PMNS_Base::ProbMatrix(): every initial flavour is propagated through one path segment before moving to the next, so that the
+ * Hamiltonian of each segment is solved once rather than once per initial flavour. The propagated states are kept in member buffers which are only
+ * allocated on the first call, and the (protected) hooks used are the ones OscProb::PMNS_Base::Prob(flvi,flvf) uses, so that the result is identical
+ * for every PMNS type. State is the type of the propagated state: OscProb::vectorC (fNuState) for most models, OscProb::matrixC (fRho) for the
+ * density matrix based models.
+ */
+template <class PMNS, class State = OscProb::vectorC>
+class OscProbPMNS : public PMNS, public OscProbMatrixFiller {
+ public:
+  using PMNS::PMNS;
+
+  void FillProbMatrix(int nflvi, int nflvf, double Energy, double* Probs) final {
+    this->SetEnergy(Energy);
+
+    if ((int)fStates.size() < nflvi) fStates.resize(nflvi);
+    for (int flvi = 0; flvi < nflvi; flvi++) {
+      this->ResetToFlavour(flvi);
+      fStates[flvi] = PropagatedState(static_cast<State*>(nullptr));
+    }
+
+    for (size_t iPath = 0; iPath < this->fNuPaths.size(); iPath++) {
+      for (int flvi = 0; flvi < nflvi; flvi++) {
+        PropagatedState(static_cast<State*>(nullptr)) = fStates[flvi];
+        this->PropagatePath(this->fNuPaths[iPath]);
+        fStates[flvi] = PropagatedState(static_cast<State*>(nullptr));
+      }
+    }
+
+    for (int flvi = 0; flvi < nflvi; flvi++) {
+      PropagatedState(static_cast<State*>(nullptr)) = fStates[flvi];
+      for (int flvf = 0; flvf < nflvf; flvf++) {
+        Probs[flvi*nflvf+flvf] = this->P(flvf);
+      }
+    }
+  }
+
+ private:
+  /**
+   * @brief The state that OscProb propagates, selected by the type of the (unused) argument
+   */
+  OscProb::vectorC& PropagatedState(OscProb::vectorC*) {return this->fNuState;}
+  OscProb::matrixC& PropagatedState(OscProb::matrixC*) {return this->fRho;}
+
+  /**
+   * @brief State of each initial flavour between path segments
+   */
+  std::vector<State> fStates;
+};
+
+/**
  * @class OscProbCalcerOscProb
  *
  * @brief Oscillation calculation engine for propagation in OscProb.
@@ -307,6 +387,21 @@ private:
    */
   OscProb::PMNS_Base* fPMNSObj;
 
+  /**
+   * @brief Pointer to #fPMNSObj viewed through the OscProbMatrixFiller interface
+   */
+  OscProbMatrixFiller* fProbMatrixFiller;
+
+  /**
+   * @brief Maximum number of neutrino flavours handled by any PMNS object (three active plus three sterile)
+   */
+  static constexpr int kMaxFlavours = 6;
+
+  /**
+   * @brief Fixed-size buffer the probability matrix is written into for each energy
+   */
+  double fProbMatrix[kMaxFlavours*kMaxFlavours];
+
 };
 
 #endif
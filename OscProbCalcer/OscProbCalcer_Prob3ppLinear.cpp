@@ -1,6 +1,7 @@
 #include "OscProbCalcer_Prob3ppLinear.h"
 
 #include <iostream>
+#include <algorithm>
 
 OscProbCalcerProb3ppLinear::OscProbCalcerProb3ppLinear(YAML::Node Config_) : OscProbCalcerBase(Config_)
 {
@@ -23,6 +24,11 @@ OscProbCalcerProb3ppLinear::OscProbCalcerProb3ppLinear(YAML::Node Config_) : Osc
   doubled_angle = true;
 
   bNu = nullptr;
+
+  // Prob3++ keeps the mixing and matter matrices in file-scope statics in mosc.c, shared by every BargerPropagator, so only a single thread is supported
+  SetSingleThreadOnly();
+  fConcurrentReweightSafe = false;
+  fImplementationName += "-CPU-"+std::to_string(1);
 }
 
 OscProbCalcerProb3ppLinear::~OscProbCalcerProb3ppLinear() {
@@ -31,24 +37,58 @@ OscProbCalcerProb3ppLinear::~OscProbCalcerProb3ppLinear() {
 }
 
 void OscProbCalcerProb3ppLinear::SetupPropagator() {
-   bNu = new BargerPropagator();
-   bNu->UseMassEigenstates(false);
-   bNu->SetOneMassScaleMode(false);
-   bNu->SetWarningSuppression(true);
+  bNu = new BargerPropagator();
+  bNu->UseMassEigenstates(false);
+  bNu->SetOneMassScaleMode(false);
+  bNu->SetWarningSuppression(true);
+
+  // A single propagation from a given generated flavour gives the probabilities for every detected flavour, so group the channels by generated flavour
+  GeneratedFlavours.clear();
+  GeneratedFlavourChannels.clear();
+  for (int iOscChannel=0;iOscChannel<fNOscillationChannels;iOscChannel++) {
+    int GeneratedFlavour = fOscillationChannels[iOscChannel].GeneratedFlavour;
+    size_t iGeneratedFlavour = std::find(GeneratedFlavours.begin(),GeneratedFlavours.end(),GeneratedFlavour)-GeneratedFlavours.begin();
+    if (iGeneratedFlavour == GeneratedFlavours.size()) {
+      GeneratedFlavours.push_back(GeneratedFlavour);
+      GeneratedFlavourChannels.push_back(std::vector<int>());
+    }
+    GeneratedFlavourChannels[iGeneratedFlavour].push_back(iOscChannel);
+  }
+
+  if (fVerbose >= NuOscillator::INFO) {std::cout << "Setup Prob3ppLinear with " << GeneratedFlavours.size() << " propagations per neutrino type and energy, using:" << fNThreads << " threads" << std::endl;}
 }
 
 void OscProbCalcerProb3ppLinear::CalculateProbabilities() {
-  // Prob3++ calculates oscillation probabilities for each NeutrinoType and each energy, so need to copy them from the calculator into fWeightArray
+  const double th12 = GetOscillationParameter(kTH12);
+  const double th13 = GetOscillationParameter(kTH13);
+  const double th23 = GetOscillationParameter(kTH23);
+  const double dm12 = GetOscillationParameter(kDM12);
+  const double dm23 = GetOscillationParameter(kDM23);
+  const double dcp = GetOscillationParameter(kDCP);
+  const double PathLength = GetOscillationParameter(kPATHL);
+  const double Density = GetOscillationParameter(kDENS);
+
+  const int nGeneratedFlavours = static_cast<int>(GeneratedFlavours.size());
+
+  // Prob3++ calculates oscillation probabilities for each NeutrinoType, energy and generated flavour, so each of those is propagated once and every
+  // requested detected flavour is copied from the calculator into fWeightArray
   for (int iNuType=0;iNuType<fNNeutrinoTypes;iNuType++) {
-    for (int iOscChannel=0;iOscChannel<fNOscillationChannels;iOscChannel++) {
-    
-      // Mapping which links the oscillation channel, neutrino type and energy index to the fWeightArray index
-      int IndexToFill = iNuType*fNOscillationChannels*fNEnergyPoints + iOscChannel*fNEnergyPoints;
-      
-      for (int iOscProb=0;iOscProb<fNEnergyPoints;iOscProb++) {
-        bNu->SetMNS(GetOscillationParameter(kTH12), GetOscillationParameter(kTH13), GetOscillationParameter(kTH23), GetOscillationParameter(kDM12), GetOscillationParameter(kDM23), GetOscillationParameter(kDCP), fEnergyArray[iOscProb], doubled_angle, fNeutrinoTypes[iNuType]);
-        bNu->propagateLinear(fNeutrinoTypes[iNuType]*fOscillationChannels[iOscChannel].GeneratedFlavour, GetOscillationParameter(kPATHL), GetOscillationParameter(kDENS));
-        fWeightArray[IndexToFill+iOscProb] = bNu->GetProb(fNeutrinoTypes[iNuType]*fOscillationChannels[iOscChannel].GeneratedFlavour, fNeutrinoTypes[iNuType]*fOscillationChannels[iOscChannel].DetectedFlavour);
+    for (int iOscProb=0;iOscProb<fNEnergyPoints;iOscProb++) {
+      const int NuType = fNeutrinoTypes[iNuType];
+
+      bNu->SetMNS(th12, th13, th23, dm12, dm23, dcp, fEnergyArray[iOscProb], doubled_angle, NuType);
+
+      for (int iGeneratedFlavour=0;iGeneratedFlavour<nGeneratedFlavours;iGeneratedFlavour++) {
+        const int GeneratedFlavour = NuType*GeneratedFlavours[iGeneratedFlavour];
+        bNu->propagateLinear(GeneratedFlavour, PathLength, Density);
+
+        const std::vector<int>& Channels = GeneratedFlavourChannels[iGeneratedFlavour];
+        for (size_t iChannel=0;iChannel<Channels.size();iChannel++) {
+          const int iOscChannel = Channels[iChannel];
+          // Mapping which links the oscillation channel, neutrino type and energy index to the fWeightArray index
+          const int IndexToFill = iNuType*fNOscillationChannels*fNEnergyPoints + iOscChannel*fNEnergyPoints + iOscProb;
+          fWeightArray[IndexToFill] = bNu->GetProb(GeneratedFlavour, NuType*fOscillationChannels[iOscChannel].DetectedFlavour);
+        }
       }
     }
   }
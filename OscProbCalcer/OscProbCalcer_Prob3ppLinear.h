@@ -96,6 +96,16 @@ class OscProbCalcerProb3ppLinear : public OscProbCalcerBase {
    * @brief BargerPropagator used within the Prob3pp calculation framework
    */
   BargerPropagator *bNu;
+
+  /**
+   * @brief The unique generated flavours in #fOscillationChannels, each of which is propagated once per neutrino type and energy
+   */
+  std::vector<int> GeneratedFlavours;
+
+  /**
+   * @brief The indices in #fOscillationChannels which share the generated flavour of the same index in #GeneratedFlavours
+   */
+  std::vector< std::vector<int> > GeneratedFlavourChannels;
 };
 
 #endif
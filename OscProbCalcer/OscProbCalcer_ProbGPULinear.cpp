@@ -24,6 +24,9 @@ OscProbCalcerProbGPULinear::OscProbCalcerProbGPULinear(YAML::Node Config_) : Osc
 
   // Implementation specific variables
   doubled_angle = true;
+
+  // probGPU holds the mixing matrix in global state set by setMNS()
+  fConcurrentReweightSafe = false;
 }
 
 OscProbCalcerProbGPULinear::~OscProbCalcerProbGPULinear() {
@@ -3,6 +3,7 @@
 #include "OscProbCalcer/OscProbCalcerFactory.h"
 
 #include <iostream>
+#include <chrono>
 
 OscillatorBase::OscillatorBase(std::string ConfigName_) {
   // Create config manager
@@ -35,6 +36,7 @@ void OscillatorBase::Initialise(YAML::Node Config_) {
 }
 
 OscillatorBase::~OscillatorBase() {
+  WaitForPendingCalculation();
   delete fOscProbCalcer;
 }
 
@@ -43,9 +45,40 @@ void OscillatorBase::InitialiseOscProbCalcer() {
   fOscProbCalcer = OscProbCalcFactory->CreateOscProbCalcer(Config);
   fOscProbCalcerSet = true;
   delete OscProbCalcFactory;
+
+  // Settings in the 'General' node override those in the OscProbCalcer config
+  if (Config["General"]["Threads"]) {
+    SetNThreads(Config["General"]["Threads"].as<int>());
+  }
+  if (Config["General"]["CPUSet"]) {
+    SetCPUSet(Config["General"]["CPUSet"].as< std::vector<int> >());
+  }
+}
+
+void OscillatorBase::SetNThreads(int NThreads) {
+  WaitForCalculation();
+  fOscProbCalcer->SetNThreads(NThreads);
+}
+
+int OscillatorBase::ReturnNThreads() {
+  return fOscProbCalcer->ReturnNThreads();
+}
+
+bool OscillatorBase::ReturnNThreadsAdjustable() {
+  return fOscProbCalcer->ReturnNThreadsAdjustable();
+}
+
+void OscillatorBase::SetCPUSet(const std::vector<int>& CPUSet) {
+  WaitForCalculation();
+  fOscProbCalcer->SetCPUSet(CPUSet);
+}
+
+bool OscillatorBase::ReturnConcurrentReweightSafe() {
+  return fOscProbCalcer->ReturnConcurrentReweightSafe();
 }
 
 void OscillatorBase::SetEnergyArrayInCalcer(std::vector<FLOAT_T> Array) {
+  WaitForCalculation();
   if (fOscProbCalcer->ReturnHasSetEnergyArray()) {
     std::cerr << "Have already set the Energy array in the requested OscProbCalcer" << std::endl;
     std::cerr << "This seems like a fault in the setup" << std::endl;
@@ -58,6 +91,7 @@ void OscillatorBase::SetEnergyArrayInCalcer(std::vector<FLOAT_T> Array) {
 }
 
 void OscillatorBase::SetCosineZArrayInCalcer(std::vector<FLOAT_T> Array) {
+  WaitForCalculation();
   if (fOscProbCalcer->ReturnHasSetCosineZArray()) {
     std::cerr << "Have already set the CosineZ array in the requested OscProbCalcer" << std::endl;
     std::cerr << "This seems like a fault in the setup"<< std::endl;
@@ -68,18 +102,77 @@ void OscillatorBase::SetCosineZArrayInCalcer(std::vector<FLOAT_T> Array) {
 }
 
 void OscillatorBase::CalculateProbabilities(const std::vector<FLOAT_T>& OscParams) {
+  WaitForCalculation();
   if (fVerbose >= NuOscillator::INFO) {std::cout << "Calculating oscillation probabilities using OscProbCalcer Implementation:" << fOscProbCalcer->ReturnImplementationName() << " in OscillatorBase object" << std::endl;}
   fOscProbCalcer->Reweight(OscParams);
   PostCalculateProbabilities();
 }
 
 void OscillatorBase::CalculateProbabilities() {
+  WaitForCalculation();
   if (fVerbose >= NuOscillator::INFO) {std::cout << "Calculating oscillation probabilities using OscProbCalcer Implementation:" << fOscProbCalcer->ReturnImplementationName() << " in OscillatorBase object" << std::endl;}
   fOscProbCalcer->Reweight();
   PostCalculateProbabilities();
 }
 
+void OscillatorBase::RunCalcerReweight() {
+  WaitForCalculation();
+  fOscProbCalcer->Reweight();
+}
+
+void OscillatorBase::RunPostCalculateProbabilities() {
+  WaitForCalculation();
+  PostCalculateProbabilities();
+}
+
+std::shared_future<void> OscillatorBase::CalculateProbabilitiesAsync() {
+  WaitForCalculation();
+  if (fVerbose >= NuOscillator::INFO) {std::cout << "Starting asynchronous calculation of oscillation probabilities using OscProbCalcer Implementation:" << fOscProbCalcer->ReturnImplementationName() << " in OscillatorBase object" << std::endl;}
+
+  // Copy the parameters on the calling thread, so they can be changed as soon as this returns
+  std::vector<FLOAT_T> OscParamsSnapshot = fOscProbCalcer->ReturnOscParamsSnapshot();
+  fPendingCalculation = std::async(std::launch::async,[this,OscParamsSnapshot]() {
+    fOscProbCalcer->ReweightFromSnapshot(OscParamsSnapshot);
+    PostCalculateProbabilities();
+  }).share();
+
+  return fPendingCalculation;
+}
+
+std::shared_future<void> OscillatorBase::CalculateProbabilitiesAsync(const std::vector<FLOAT_T>& OscParams) {
+  WaitForCalculation();
+  if (fVerbose >= NuOscillator::INFO) {std::cout << "Starting asynchronous calculation of oscillation probabilities using OscProbCalcer Implementation:" << fOscProbCalcer->ReturnImplementationName() << " in OscillatorBase object" << std::endl;}
+
+  fPendingCalculation = std::async(std::launch::async,[this,OscParams]() {
+    fOscProbCalcer->Reweight(OscParams);
+    PostCalculateProbabilities();
+  }).share();
+
+  return fPendingCalculation;
+}
+
+void OscillatorBase::WaitForCalculation() {
+  if (fPendingCalculation.valid()) {
+    // Release the pending calculation before get() so an exception is only rethrown once
+    std::shared_future<void> PendingCalculation = fPendingCalculation;
+    fPendingCalculation = std::shared_future<void>();
+    PendingCalculation.get();
+  }
+}
+
+void OscillatorBase::WaitForPendingCalculation() {
+  // Used by destructors, which can not throw. An exception is still available from the future returned by CalculateProbabilitiesAsync()
+  if (fPendingCalculation.valid()) {
+    fPendingCalculation.wait();
+  }
+}
+
+bool OscillatorBase::IsCalculationPending() {
+  return fPendingCalculation.valid() && fPendingCalculation.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
 void OscillatorBase::Setup() {
+  WaitForCalculation();
   if (fVerbose >= NuOscillator::INFO) {std::cout << "Setting up OscProbCalcer Implementation:" << fOscProbCalcer->ReturnImplementationName() << " in OscillatorBase object" << std::endl;}
   fOscProbCalcer->Setup();
 
@@ -100,6 +193,14 @@ std::vector<FLOAT_T> OscillatorBase::ReturnEnergyArray() {
   return fOscProbCalcer->ReturnEnergyArray();
 }
 
+long OscillatorBase::ReturnWeightArrayBytes() {
+  return fOscProbCalcer->ReturnWeightArrayBytes();
+}
+
+long OscillatorBase::ReturnLookupTableBytes() {
+  return fOscProbCalcer->ReturnLookupTableBytes();
+}
+
 int OscillatorBase::ReturnNCosineZPoints() {
   return fOscProbCalcer->ReturnNCosineZPoints();
 }
@@ -139,7 +240,13 @@ void OscillatorBase::SanityCheck() {
   }
 }
 
+std::vector<NuOscillator::OscillationProbability> OscillatorBase::ReturnProbabilities() {
+  WaitForCalculation();
+  return fOscProbCalcer->ReturnProbabilities();
+}
+
 void OscillatorBase::PrintWeights() {
+  WaitForCalculation();
   fOscProbCalcer->PrintWeights();
 }
 
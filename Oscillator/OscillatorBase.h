@@ -6,6 +6,8 @@
 
 #include "yaml-cpp/yaml.h"
 
+#include <future>
+
 /**
  * @file OscillatorBase.h
  *
@@ -48,6 +50,54 @@ class OscillatorBase {
    */
   void CalculateProbabilities();
 
+  /**
+   * @brief Run only the OscProbCalcerBase::Reweight() stage of CalculateProbabilities()
+   *
+   * Intended for profiling the two stages separately. The weights are only valid once RunPostCalculateProbabilities() has also been called
+   */
+  void RunCalcerReweight();
+
+  /**
+   * @brief Run only the implementation specific PostCalculateProbabilities() stage of CalculateProbabilities(). See RunCalcerReweight()
+   */
+  void RunPostCalculateProbabilities();
+
+  /**
+   * @brief Start CalculateProbabilities() on another thread and return immediately
+   *
+   * The oscillation parameters are copied when this is called, so the values registered with DefineParameter() can be changed (e.g. to prepare the next proposal)
+   * whilst the calculation runs. Until the returned future is ready the weights behind any pointer returned by ReturnWeightPointer() must not be read. Functions
+   * of this object which read or change the weights, including another CalculateProbabilities(), wait for the pending calculation first. Any exception is
+   * rethrown by get() on the returned future, and also by the next of those functions (see WaitForCalculation()).
+   *
+   * Each call runs on a new std::thread (std::launch::async), so an engine using OpenMP starts a new thread team every time. This costs tens of microseconds,
+   * which is only worth paying for calculations much longer than that (e.g. NuSQUIDS or OscProb atmospheric grids).
+   *
+   * @return Future which is ready once the probabilities have been calculated
+   */
+  std::shared_future<void> CalculateProbabilitiesAsync();
+
+  /**
+   * @brief Legacy mode version of CalculateProbabilitiesAsync()
+   *
+   * @param OscParams Vector of oscillation parameters to calculate probabities at, copied when this is called
+   *
+   * @return Future which is ready once the probabilities have been calculated
+   */
+  std::shared_future<void> CalculateProbabilitiesAsync(const std::vector<FLOAT_T>& OscParams);
+
+  /**
+   * @brief Block until the calculation started by CalculateProbabilitiesAsync() has finished, if any, and rethrow any exception it threw
+   *
+   * The exception is only rethrown once, such that the weights (which are then not valid) are not silently used by the following calls
+   */
+  void WaitForCalculation();
+
+  /**
+   * @brief Return whether a calculation started by CalculateProbabilitiesAsync() is still running
+   */
+  bool IsCalculationPending();
+
   /**
    * @brief Define the oscillation parameters with a given name and pointer to a value
    *
@@ -60,6 +110,7 @@ class OscillatorBase {
       throw std::runtime_error("DefineParameter function called before OscProbCalcer set");
     }
     
+    WaitForCalculation();
     fOscProbCalcer->DefineParameter(ParName_,ParValue_);
   }
 
@@ -96,6 +147,37 @@ class OscillatorBase {
    */
   std::string ReturnImplementationName();
 
+  /**
+   * @brief Set the number of threads used by #fOscProbCalcer and by any post-calculation averaging
+   *
+   * Can also be set with 'General''Threads'. Implementations which allocate per-thread resources only accept a change before Setup()
+   *
+   * @param NThreads Number of threads, which must be at least 1
+   */
+  void SetNThreads(int NThreads);
+
+  /**
+   * @brief Return the number of threads used by #fOscProbCalcer
+   */
+  int ReturnNThreads();
+
+  /**
+   * @brief Return whether SetNThreads() currently accepts a different number of threads (see OscProbCalcerBase::ReturnNThreadsAdjustable())
+   */
+  bool ReturnNThreadsAdjustable();
+
+  /**
+   * @brief Bind the threads used by #fOscProbCalcer to a set of CPUs, see OscProbCalcerBase::SetCPUSet(). Can also be set with 'General''CPUSet'
+   *
+   * @param CPUSet CPU indices. An empty vector restores the affinity the threads had before they were bound
+   */
+  void SetCPUSet(const std::vector<int>& CPUSet);
+
+  /**
+   * @brief Return whether CalculateProbabilities() can run at the same time as CalculateProbabilities() of another OscillatorBase() instance
+   */
+  bool ReturnConcurrentReweightSafe();
+
   /**
    * @brief Return the number of Energy points which are being evaluated in the OscProbCalcerBase::OscProbCalcerBase() object
    *
@@ -133,6 +215,21 @@ class OscillatorBase {
    * @return Return the neutrino types the specific implementation expects
    */
   std::vector<int> ReturnNeutrinoTypes();
+
+  /**
+   * @brief Return the oscillation probabilities calculated by the OscProbCalcerBase::OscProbCalcerBase() object, along with the channel, energy and cosine zenith of each
+   */
+  std::vector<NuOscillator::OscillationProbability> ReturnProbabilities();
+
+  /**
+   * @brief Return the number of bytes allocated for oscillation probabilities, both in the OscProbCalcerBase::OscProbCalcerBase() object and in this object
+   */
+  virtual long ReturnWeightArrayBytes();
+
+  /**
+   * @brief Return the number of bytes allocated for evaluation points, binning and weight lookup tables, both in the OscProbCalcerBase::OscProbCalcerBase() object and in this object
+   */
+  virtual long ReturnLookupTableBytes();
   
   /**
    * @brief Check whether a particular OscProbCalcerBase::OscProbCalcerBase() instance has a particular oscillation channel
@@ -278,6 +375,11 @@ class OscillatorBase {
    */
   virtual void SetupOscillatorImplementation() {}
 
+  /**
+   * @brief Block until the calculation started by CalculateProbabilitiesAsync() has finished without rethrowing its exception, for use in destructors
+   */
+  void WaitForPendingCalculation();
+
   // ========================================================================================================================================================================
   // Basic protected variables required for oscillation probability calculation
 
@@ -338,6 +440,11 @@ class OscillatorBase {
    */
   bool fOscProbCalcerSet;
 
+  /**
+   * @brief Calculation started by CalculateProbabilitiesAsync(), invalid if none has been started
+   */
+  std::shared_future<void> fPendingCalculation;
+
 };
 
 #endif
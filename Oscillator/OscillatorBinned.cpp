@@ -46,6 +46,8 @@ void OscillatorBinned::Initialise() {
 }
 
 OscillatorBinned::~OscillatorBinned() {
+  // PostCalculateProbabilities() of a pending calculation may still use this object
+  WaitForPendingCalculation();
 }
 
 const FLOAT_T* OscillatorBinned::ReturnWeightPointer(int InitNuFlav, int FinalNuFlav, FLOAT_T EnergyVal, FLOAT_T CosineZVal) {
@@ -106,3 +108,9 @@ std::vector<FLOAT_T> OscillatorBinned::ReturnBinEdgesForPlotting(bool ReturnEner
     return CosineZAxisBinEdges;
   }
 }
+
+long OscillatorBinned::ReturnLookupTableBytes() {
+  long Bytes = OscillatorBase::ReturnLookupTableBytes();
+  Bytes += (EnergyAxisBinEdges.capacity()+CosineZAxisBinEdges.capacity()+EnergyAxisBinCenters.capacity()+CosineZAxisBinCenters.capacity())*sizeof(FLOAT_T);
+  return Bytes;
+}
@@ -61,6 +61,11 @@ class OscillatorBinned : public OscillatorBase {
    *
    */
   std::vector<FLOAT_T> ReturnBinEdgesForPlotting(bool ReturnEnergy) final;
+
+  /**
+   * @brief Return the number of bytes allocated for the evaluation points and the bin edges and centers
+   */
+  long ReturnLookupTableBytes() final;
   
   // ========================================================================================================================================================================
   // Public virtual functions which need calculater specific implementations
@@ -0,0 +1,220 @@
+#include "Oscillator/OscillatorGroup.h"
+
+#if UseMultithreading == 1
+#include "omp.h"
+#endif
+
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <thread>
+#include <limits>
+
+OscillatorGroup::OscillatorGroup() {
+  fVerbose = NuOscillator::NONE;
+  fCostsMeasured = false;
+  fLastThreadSplit = std::make_pair(0,0);
+
+  fNThreads = 1;
+#if UseMultithreading == 1
+  fNThreads = omp_get_max_threads();
+#endif
+}
+
+OscillatorGroup::~OscillatorGroup() {
+}
+
+void OscillatorGroup::AddOscillator(OscillatorBase* Oscillator) {
+  if (Oscillator == NULL) {
+    std::cerr << "Can not add a NULL Oscillator to OscillatorGroup" << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+
+  fOscillators.push_back(Oscillator);
+  fCosts = std::vector<double>(fOscillators.size(),0.);
+  fLastTimes = std::vector<double>(fOscillators.size(),0.);
+  fLastRunOnTeam = std::vector<bool>(fOscillators.size(),false);
+  fExceptions = std::vector<std::exception_ptr>(fOscillators.size(),nullptr);
+  fCostsMeasured = false;
+}
+
+void OscillatorGroup::SetNThreads(int NThreads) {
+  if (NThreads < 1) {
+    std::cerr << "Invalid number of threads requested in OscillatorGroup:" << NThreads << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+#if UseMultithreading != 1
+  if (NThreads != 1) {
+    std::cerr << "Requested " << NThreads << " threads in OscillatorGroup but NuOscillator was built without multithreading" << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+#endif
+  fNThreads = NThreads;
+}
+
+OscillatorBase* OscillatorGroup::ReturnOscillator(int iOscillator) {
+  if (iOscillator < 0 || iOscillator >= (int)fOscillators.size()) {
+    std::cerr << "Requested Oscillator:" << iOscillator << " from OscillatorGroup which holds " << fOscillators.size() << " Oscillators" << std::endl;
+    throw std::runtime_error("Invalid setup");
+  }
+  return fOscillators[iOscillator];
+}
+
+void OscillatorGroup::SetVerbosity(std::string Verbosity) {
+  fVerbose = Verbosity_StrToInt(Verbosity);
+}
+
+void OscillatorGroup::RunOscillator(int iOscillator, int NThreads, bool AsTask) {
+  OscillatorBase* Oscillator = fOscillators[iOscillator];
+  int OwnNThreads = Oscillator->ReturnNThreads();
+  bool AssignThreads = false;
+  int ThreadsUsed = AsTask ? 1 : OwnNThreads;
+
+  auto Start = std::chrono::steady_clock::now();
+  try {
+    // Oscillators which size per-thread resources at Setup() keep their own number of threads
+    if (!AsTask && NThreads != OwnNThreads && Oscillator->ReturnNThreadsAdjustable()) {
+      Oscillator->SetNThreads(NThreads);
+      AssignThreads = true;
+      ThreadsUsed = NThreads;
+    }
+    Start = std::chrono::steady_clock::now();
+    Oscillator->CalculateProbabilities();
+  } catch (...) {
+    // Exceptions can not leave an OpenMP task or the team phase thread, so are rethrown by CalculateProbabilities() once the step has finished
+    fExceptions[iOscillator] = std::current_exception();
+  }
+  auto End = std::chrono::steady_clock::now();
+
+  if (AssignThreads) {
+    Oscillator->SetNThreads(OwnNThreads);
+  }
+
+  fLastTimes[iOscillator] = std::chrono::duration<double,std::milli>(End-Start).count();
+  fCosts[iOscillator] = fLastTimes[iOscillator]*ThreadsUsed;
+}
+
+void OscillatorGroup::RunTeamPhase(const std::vector<int>& TeamOscillators, int NThreads) {
+  for (size_t iTeam=0;iTeam<TeamOscillators.size();iTeam++) {
+    RunOscillator(TeamOscillators[iTeam],NThreads,false);
+  }
+}
+
+void OscillatorGroup::RunTaskPhase(const std::vector<int>& TaskOscillators, int NThreads) {
+  if (TaskOscillators.size() == 0) return;
+
+#if UseMultithreading == 1
+  #pragma omp parallel num_threads(NThreads)
+  {
+    #pragma omp single
+    {
+      for (size_t iTask=0;iTask<TaskOscillators.size();iTask++) {
+        int iOscillator = TaskOscillators[iTask];
+        #pragma omp task firstprivate(iOscillator)
+        RunOscillator(iOscillator,1,true);
+      }
+    }
+  }
+#else
+  (void)NThreads;
+  for (size_t iTask=0;iTask<TaskOscillators.size();iTask++) {
+    RunOscillator(TaskOscillators[iTask],1,true);
+  }
+#endif
+}
+
+void OscillatorGroup::CalculateProbabilities() {
+  int nOscillators = (int)fOscillators.size();
+  if (nOscillators == 0) return;
+
+  // Before the first step the cost of each Oscillator is taken as its number of evaluation points
+  if (!fCostsMeasured) {
+    for (int iOscillator=0;iOscillator<nOscillators;iOscillator++) {
+      fCosts[iOscillator] = (double)fOscillators[iOscillator]->ReturnNEnergyPoints()*std::max(1,fOscillators[iOscillator]->ReturnNCosineZPoints());
+    }
+  }
+
+  // Schedule the most expensive Oscillators first
+  std::vector<int> Order(nOscillators);
+  std::iota(Order.begin(),Order.end(),0);
+  std::stable_sort(Order.begin(),Order.end(),[this](int a, int b) {return fCosts[a] > fCosts[b];});
+
+  // An Oscillator which would take longer on one thread than the balanced step is split across the whole team instead
+  double TotalCost = std::accumulate(fCosts.begin(),fCosts.end(),0.);
+  double BalancedCost = TotalCost/fNThreads;
+
+  std::vector<int> TeamOscillators;
+  std::vector<int> TaskOscillators;
+  double TeamCost = 0.;
+  double TaskCost = 0.;
+  for (int iOrder=0;iOrder<nOscillators;iOrder++) {
+    int iOscillator = Order[iOrder];
+    bool RunOnTeam = (fNThreads > 1 && fCosts[iOscillator] >= BalancedCost) || !fOscillators[iOscillator]->ReturnConcurrentReweightSafe();
+    if (RunOnTeam) {
+      TeamOscillators.push_back(iOscillator);
+      TeamCost += fCosts[iOscillator];
+    } else {
+      TaskOscillators.push_back(iOscillator);
+      TaskCost += fCosts[iOscillator];
+    }
+    fLastRunOnTeam[iOscillator] = RunOnTeam;
+    fExceptions[iOscillator] = nullptr;
+  }
+
+  // When both phases hold Oscillators they overlap, with the threads split such that the slower phase finishes as early as possible. The task phase can not
+  // finish before its longest Oscillator
+  bool Overlap = (fNThreads > 1 && TeamOscillators.size() > 0 && TaskOscillators.size() > 0);
+  int TeamThreads = fNThreads;
+  int TaskThreads = fNThreads;
+  if (Overlap) {
+    double LongestTaskCost = fCosts[TaskOscillators[0]];
+    double BestStepCost = std::numeric_limits<double>::max();
+    for (int nTaskThreads=1;nTaskThreads<fNThreads;nTaskThreads++) {
+      double StepCost = std::max(TeamCost/(fNThreads-nTaskThreads),std::max(TaskCost/nTaskThreads,LongestTaskCost));
+      if (StepCost < BestStepCost) {
+        BestStepCost = StepCost;
+        TaskThreads = nTaskThreads;
+      }
+    }
+    TeamThreads = fNThreads-TaskThreads;
+  }
+  fLastThreadSplit = std::make_pair(TeamOscillators.size() > 0 ? TeamThreads : 0,TaskOscillators.size() > 0 ? TaskThreads : 0);
+
+  if (fVerbose >= NuOscillator::INFO) {
+    std::cout << "OscillatorGroup running " << TeamOscillators.size() << " Oscillators in the team phase on " << fLastThreadSplit.first << " threads and "
+              << TaskOscillators.size() << " as tasks on " << fLastThreadSplit.second << " threads" << (Overlap ? ", at the same time" : "") << std::endl;
+  }
+
+#if UseMultithreading == 1
+  // Each task runs its engine on the thread executing it, so nested parallel regions are disabled for the duration of the step. The team phase runs on its own
+  // std::thread when overlapping, where the parallel regions of its engines are outermost and so keep their team
+  int PreviousMaxActiveLevels = omp_get_max_active_levels();
+  omp_set_max_active_levels(1);
+
+  if (Overlap) {
+    std::thread TeamPhase(&OscillatorGroup::RunTeamPhase,this,std::cref(TeamOscillators),TeamThreads);
+    RunTaskPhase(TaskOscillators,TaskThreads);
+    TeamPhase.join();
+  } else {
+    RunTeamPhase(TeamOscillators,TeamThreads);
+    RunTaskPhase(TaskOscillators,TaskThreads);
+  }
+
+  omp_set_max_active_levels(PreviousMaxActiveLevels);
+#else
+  RunTeamPhase(TeamOscillators,TeamThreads);
+  RunTaskPhase(TaskOscillators,TaskThreads);
+#endif
+
+  fCostsMeasured = true;
+
+  for (int iOscillator=0;iOscillator<nOscillators;iOscillator++) {
+    if (fExceptions[iOscillator] != nullptr) {
+      std::cerr << "Oscillator:" << iOscillator << " (" << fOscillators[iOscillator]->ReturnImplementationName() << ") in OscillatorGroup threw during CalculateProbabilities()" << std::endl;
+      // Costs of a failed step are not representative
+      fCostsMeasured = false;
+      std::rethrow_exception(fExceptions[iOscillator]);
+    }
+  }
+}
@@ -0,0 +1,175 @@
+#ifndef __OSCILLATOR_GROUP_H__
+#define __OSCILLATOR_GROUP_H__
+
+#include "OscillatorBase.h"
+
+#include <vector>
+#include <exception>
+#include <utility>
+
+/**
+ * @file OscillatorGroup.h
+ *
+ * @class OscillatorGroup
+ *
+ * @brief Scheduler which calculates the oscillation probabilities of many independent OscillatorBase::OscillatorBase() objects in one step.
+ *
+ * Each step is split in two phases, using the cost of every Oscillator measured in the previous step (or its number of evaluation points before the first step):
+ * - Oscillators whose cost is at least the group total divided by the number of threads, together with any which can not run concurrently with other instances
+ *   (see OscillatorBase::ReturnConcurrentReweightSafe()), form the team phase. They are calculated one after the other on a thread team, such that the engine splits
+ *   its grid into chunks across those threads. These set the critical path of the step.
+ * - The remaining Oscillators form the task phase. They are calculated as OpenMP tasks on one shared pool, longest first, each on a single thread.
+ *
+ * When both phases hold Oscillators, they run at the same time: the threads are split between them such that the predicted step time is smallest, and the team phase
+ * runs on its own std::thread. Oscillators which size per-thread resources at Setup() (see OscillatorBase::ReturnNThreadsAdjustable()) keep their own number of
+ * threads in the team phase, all others are given the threads of the team phase for the duration of their calculation.
+ *
+ * The group does not own the Oscillators, which must have been setup before calling CalculateProbabilities().
+ */
+class OscillatorGroup {
+ public:
+
+  /**
+   * @brief Default constructor
+   */
+  OscillatorGroup();
+
+  /**
+   * @brief Destructor. The Oscillators are not deleted
+   */
+  virtual ~OscillatorGroup();
+
+  /**
+   * @brief Add an Oscillator to the group. Resets the measured costs so the next step is scheduled on the number of evaluation points
+   *
+   * @param Oscillator Oscillator which has been (or will be) setup by the caller
+   */
+  void AddOscillator(OscillatorBase* Oscillator);
+
+  /**
+   * @brief Calculate the oscillation probabilities of every Oscillator in the group, equivalent to calling OscillatorBase::CalculateProbabilities() on each in turn
+   *
+   * Any exception thrown by an Oscillator is rethrown once the step has finished
+   */
+  void CalculateProbabilities();
+
+  /**
+   * @brief Set the number of threads in the shared pool, defaults to the global OpenMP setting when the group is created
+   *
+   * @param NThreads Number of threads, at least 1
+   */
+  void SetNThreads(int NThreads);
+
+  /**
+   * @brief Return the number of threads in the shared pool
+   */
+  int ReturnNThreads() {return fNThreads;}
+
+  /**
+   * @brief Return the number of Oscillators in the group
+   */
+  int ReturnNOscillators() {return (int)fOscillators.size();}
+
+  /**
+   * @brief Return an Oscillator in the group
+   *
+   * @param iOscillator Index in the order the Oscillators were added
+   */
+  OscillatorBase* ReturnOscillator(int iOscillator);
+
+  /**
+   * @brief Return the wall time in ms taken by each Oscillator in the last step, in the order they were added
+   */
+  std::vector<double> ReturnLastCalculationTimes() {return fLastTimes;}
+
+  /**
+   * @brief Return whether each Oscillator was calculated in the team phase (true) or as a single threaded task (false) in the last step
+   */
+  std::vector<bool> ReturnLastRunOnTeam() {return fLastRunOnTeam;}
+
+  /**
+   * @brief Return the number of threads given to the team phase and to the task phase in the last step. They sum to ReturnNThreads() when both phases overlapped
+   */
+  std::pair<int,int> ReturnLastThreadSplit() {return fLastThreadSplit;}
+
+  /**
+   * @brief Set the verbosity used when printing the schedule of each step
+   *
+   * @param Verbosity String verbosity (see Verbosity_StrToInt())
+   */
+  void SetVerbosity(std::string Verbosity);
+
+ private:
+
+  /**
+   * @brief Calculate the probabilities of one Oscillator, store its wall time and catch any exception
+   *
+   * @param iOscillator Index in #fOscillators
+   * @param NThreads Number of threads given to the Oscillator, used to convert the wall time to a single thread cost
+   * @param AsTask Whether the Oscillator runs as a task, where nested parallel regions are disabled so its thread count is left alone
+   */
+  void RunOscillator(int iOscillator, int NThreads, bool AsTask);
+
+  /**
+   * @brief Calculate the Oscillators of the team phase one after the other
+   *
+   * @param TeamOscillators Indices in #fOscillators
+   * @param NThreads Number of threads given to each Oscillator
+   */
+  void RunTeamPhase(const std::vector<int>& TeamOscillators, int NThreads);
+
+  /**
+   * @brief Calculate the Oscillators of the task phase as OpenMP tasks
+   *
+   * @param TaskOscillators Indices in #fOscillators, longest first
+   * @param NThreads Number of threads in the pool
+   */
+  void RunTaskPhase(const std::vector<int>& TaskOscillators, int NThreads);
+
+  /**
+   * @brief Oscillators in the group, not owned
+   */
+  std::vector<OscillatorBase*> fOscillators;
+
+  /**
+   * @brief Single thread equivalent cost of each Oscillator, in ms from the last step or the number of evaluation points before the first step
+   */
+  std::vector<double> fCosts;
+
+  /**
+   * @brief Wall time in ms of each Oscillator in the last step
+   */
+  std::vector<double> fLastTimes;
+
+  /**
+   * @brief Whether each Oscillator was calculated with the whole thread team in the last step
+   */
+  std::vector<bool> fLastRunOnTeam;
+
+  /**
+   * @brief Number of threads given to the team phase and to the task phase in the last step
+   */
+  std::pair<int,int> fLastThreadSplit;
+
+  /**
+   * @brief Exception thrown by each Oscillator in the current step, if any
+   */
+  std::vector<std::exception_ptr> fExceptions;
+
+  /**
+   * @brief Whether #fCosts hold measured times
+   */
+  bool fCostsMeasured;
+
+  /**
+   * @brief Number of threads in the shared pool
+   */
+  int fNThreads;
+
+  /**
+   * @brief Verbosity level
+   */
+  int fVerbose;
+};
+
+#endif
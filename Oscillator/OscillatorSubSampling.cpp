@@ -73,6 +73,8 @@ void OscillatorSubSampling::Initialise() {
 }
 
 OscillatorSubSampling::~OscillatorSubSampling() {
+  // PostCalculateProbabilities() of a pending calculation may still use this object
+  WaitForPendingCalculation();
 }
 
 void OscillatorSubSampling::SetupOscillatorImplementation() {
@@ -198,7 +200,7 @@ const FLOAT_T* OscillatorSubSampling::ReturnWeightPointer(int InitNuFlav, int Fi
 
 void OscillatorSubSampling::PostCalculateProbabilities() {
   #if UseMultithreading == 1
-  #pragma omp parallel for
+  #pragma omp parallel for num_threads(fOscProbCalcer->ReturnNThreads())
   #endif
   for (size_t iBin = 0; iBin < AveragedOscillationProbabilities.size(); ++iBin) {
     FLOAT_T Avg = 0.;
@@ -223,3 +225,18 @@ std::vector<FLOAT_T> OscillatorSubSampling::ReturnBinEdgesForPlotting(bool Retur
     return CoarseCosineZAxisBinEdges;
   }
 }
+
+long OscillatorSubSampling::ReturnWeightArrayBytes() {
+  return OscillatorBase::ReturnWeightArrayBytes()+AveragedOscillationProbabilities.capacity()*sizeof(FLOAT_T);
+}
+
+long OscillatorSubSampling::ReturnLookupTableBytes() {
+  long Bytes = OscillatorBase::ReturnLookupTableBytes();
+  Bytes += OscillationProbabilitiesToAverage.capacity()*sizeof(std::vector<const FLOAT_T*>);
+  for (size_t iBin=0;iBin<OscillationProbabilitiesToAverage.size();iBin++) {
+    Bytes += OscillationProbabilitiesToAverage[iBin].capacity()*sizeof(const FLOAT_T*);
+  }
+  Bytes += (CoarseEnergyAxisBinEdges.capacity()+FineEnergyAxisBinEdges.capacity()+CoarseCosineZAxisBinEdges.capacity()+FineCosineZAxisBinEdges.capacity()
+	    +FineEnergyAxisBinCenters.capacity()+FineCosineZAxisBinCenters.capacity())*sizeof(FLOAT_T);
+  return Bytes;
+}
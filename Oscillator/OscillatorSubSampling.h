@@ -68,6 +68,16 @@ class OscillatorSubSampling : public OscillatorBase {
    *
    */
   std::vector<FLOAT_T> ReturnBinEdgesForPlotting(bool ReturnEnergy) final;
+
+  /**
+   * @brief Return the number of bytes allocated for the fine oscillation probabilities and the coarse bin averages
+   */
+  long ReturnWeightArrayBytes() final;
+
+  /**
+   * @brief Return the number of bytes allocated for the evaluation points, the binning and the table of fine probabilities to average in each coarse bin
+   */
+  long ReturnLookupTableBytes() final;
   
   // ========================================================================================================================================================================
   // Public virtual functions which need calculater specific implementations
@@ -15,7 +15,8 @@ void OscillatorUnbinned::Initialise() {
 }
 
 OscillatorUnbinned::~OscillatorUnbinned() {
-
+  // PostCalculateProbabilities() of a pending calculation may still use this object
+  WaitForPendingCalculation();
 }
 
 const FLOAT_T* OscillatorUnbinned::ReturnWeightPointer(int InitNuFlav, int FinalNuFlav, FLOAT_T EnergyVal, FLOAT_T CosineZVal) {
@@ -0,0 +1,3 @@
+if(${UseNativeEarth} EQUAL 1)
+  target_compile_definitions(NuOscillatorCompilerOptions INTERFACE UseNativeEarth=1)
+endif()
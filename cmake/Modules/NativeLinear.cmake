@@ -0,0 +1,3 @@
+if(${UseNativeLinear} EQUAL 1)
+  target_compile_definitions(NuOscillatorCompilerOptions INTERFACE UseNativeLinear=1)
+endif()